@@ -0,0 +1,364 @@
+#include "json.h"
+#include "json_reader.h"
+#include "hub_labels.h"
+#include "landmarks.h"
+#include "map_renderer.h"
+#include "pareto_router.h"
+#include "router.h"
+#include "serialization.h"
+#include "synthetic_city.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+    struct BenchmarkOptions {
+        std::vector<size_t> scales{ 1000, 10000, 100000 };
+        // построение graph::Router кубическое по числу вершин,
+        // поэтому на больших сетях его бенчмарки пропускаются
+        size_t router_stop_limit = 1000;
+        std::optional<size_t> bus_count;
+        synthetic::CityParams city;
+        bool emit_base = false;
+    };
+
+    // описания ссылаются на строки исходного документа
+    using catalogue::StopDescription;
+    using catalogue::BusDescription;
+
+    class BenchmarkPrinter {
+    public:
+        explicit BenchmarkPrinter(std::ostream& out)
+            : out_(out) {
+            out_ << std::left << std::setw(40) << "benchmark"sv << std::setw(10) << "stops"sv
+                << std::right << std::setw(12) << "iterations"sv << std::setw(16) << "us/iteration"sv << '\n';
+        }
+
+        void Print(std::string_view name, size_t scale, size_t iterations, double microseconds) {
+            out_ << std::left << std::setw(40) << name << std::setw(10) << scale
+                << std::right << std::setw(12) << iterations << std::setw(16) << std::fixed << std::setprecision(1)
+                << microseconds / iterations << std::endl;
+        }
+
+        void PrintSkipped(std::string_view name, size_t scale) {
+            out_ << std::left << std::setw(40) << name << std::setw(10) << scale
+                << std::right << std::setw(28) << "skipped"sv << std::endl;
+        }
+
+    private:
+        std::ostream& out_;
+    };
+
+    // Запускает setup() и body(state) до тех пор, пока суммарное время body
+    // не превысит min_time, но не более max_iterations раз
+    template <typename Setup, typename Body>
+    void Measure(BenchmarkPrinter& printer, std::string_view name, size_t scale, Setup setup, Body body) {
+        using Clock = std::chrono::steady_clock;
+        static const auto min_time = 200ms;
+        static const size_t max_iterations = 1000;
+
+        Clock::duration total{};
+        size_t iterations = 0;
+        while (total < min_time && iterations < max_iterations) {
+            auto state = setup();
+            const auto start = Clock::now();
+            body(state);
+            total += Clock::now() - start;
+            ++iterations;
+        }
+        printer.Print(name, scale, iterations, std::chrono::duration<double, std::micro>(total).count());
+    }
+
+    template <typename Body>
+    void Measure(BenchmarkPrinter& printer, std::string_view name, size_t scale, Body body) {
+        Measure(printer, name, scale, [] { return 0; }, [&body](int) { body(); });
+    }
+
+    void ReadDescriptions(const json::Document& doc, std::vector<StopDescription>& stops, std::vector<BusDescription>& buses) {
+        for (const json::Node& request : doc.GetRoot().AsDict().at("base_requests").AsArray()) {
+            const json::Dict& dict = request.AsDict();
+            if (dict.at("type").AsString() == "Stop"sv) {
+                StopDescription& stop = stops.emplace_back(StopDescription{
+                    dict.at("name").AsString(), { dict.at("latitude").AsDouble(), dict.at("longitude").AsDouble() }, {} });
+                for (const auto& [name_to, distance] : dict.at("road_distances").AsDict()) {
+                    stop.road_distances.emplace_back(name_to, distance.AsInt());
+                }
+            }
+            else {
+                BusDescription bus{ dict.at("name").AsString(), {}, dict.at("is_roundtrip").AsBool() ? BusType::CYCLED : BusType::ORDINARY };
+                for (const json::Node& stop : dict.at("stops").AsArray()) {
+                    bus.stops.push_back(stop.AsString());
+                }
+                buses.push_back(std::move(bus));
+            }
+        }
+    }
+
+    void RunBenchmarks(const BenchmarkOptions& options, size_t scale, BenchmarkPrinter& printer) {
+        synthetic::CityParams params = options.city;
+        params.stop_count = scale;
+        params.bus_count = options.bus_count.value_or(std::max<size_t>(1, scale / 10));
+        params.serialization_file = (std::filesystem::temp_directory_path() / "transport_catalogue_benchmark.db").string();
+
+        const json::Document doc = synthetic::GenerateBase(params);
+        std::ostringstream printed;
+        json::Print(doc, printed);
+        const std::string text = printed.str();
+
+        Measure(printer, "json::Load"sv, scale, [&text] {
+            std::istringstream input(text);
+            json::Load(input);
+            });
+
+        std::vector<StopDescription> stops;
+        std::vector<BusDescription> buses;
+        ReadDescriptions(doc, stops, buses);
+        const json_reader::JsonReader reader(doc);
+
+        auto make_catalogue_with_stops = [&stops] {
+            catalogue::TransportCatalogue cat;
+            for (const auto& stop : stops) {
+                cat.AddStop(stop.name, stop.coordinates);
+            }
+            return cat;
+        };
+        Measure(printer, "TransportCatalogue::AddBus"sv, scale, make_catalogue_with_stops,
+            [&buses](catalogue::TransportCatalogue& cat) {
+                for (const auto& bus : buses) {
+                    cat.AddBus(bus.name, bus.stops, bus.type);
+                }
+                cat.BuildStopBuses();
+            });
+
+        Measure(printer, "TransportCatalogue::AddBulk"sv, scale, [&stops, &buses] {
+            catalogue::TransportCatalogue cat;
+            cat.AddBulk(stops, buses);
+            });
+
+        catalogue::TransportCatalogue cat;
+        catalogue::TransportRouter transport_router(reader.ReadRoutingSettings(doc), cat);
+        json_reader::JsonReader(doc).Fill(cat, transport_router);
+
+        Measure(printer, "TransportCatalogue::ComputeBusInfo"sv, scale, [&cat, &buses] {
+            for (const auto& bus : buses) {
+                cat.GetBusInfo(bus.name);
+            }
+            });
+
+        Measure(printer, "TransportCatalogue::GetStopInfo"sv, scale, [&cat, &stops] {
+            for (const auto& stop : stops) {
+                cat.GetStopInfo(stop.name);
+            }
+            });
+
+        Measure(printer, "TransportRouter graph construction"sv, scale, [&] {
+            catalogue::TransportRouter local_router(reader.ReadRoutingSettings(doc), cat);
+            for (const auto& stop : cat.GetStops()) {
+                local_router.AddStopVertex(&stop);
+            }
+            local_router.AddBusWaitEdges();
+            for (const auto& bus : buses) {
+                local_router.AddBusEdges(bus.name);
+            }
+            });
+
+        // пересчёт весов для другой метрики на том же графе; затем исходные веса возвращаются
+        {
+            const catalogue::RoutingSettings settings = transport_router.GetRoutingSettings();
+            Measure(printer, "TransportRouter::Customize"sv, scale, [&] {
+                transport_router.Customize(settings.bus_wait_time + 2.0, settings.bus_velocity * 0.75);
+                });
+            transport_router.Customize(settings.bus_wait_time, settings.bus_velocity);
+        }
+
+        Measure(printer, "MapRenderer rendering"sv, scale, [&] {
+            renderer::MapRenderer renderer(reader.GetRenderSettings(), cat.GetBusesSorted());
+            renderer.RenderRoutes(cat.GetBusesSorted());
+            renderer.RenderStops(cat.GetStopsWithBusesSorted());
+            svg::Buffer out;
+            renderer.Render(out);
+            });
+
+        Measure(printer, "ParetoRouter::FindRoutes"sv, scale, [&] {
+            catalogue::ParetoRouter pareto_router(transport_router.GetRouteGraph<BusRouteWeight>());
+            catalogue::ParetoRoutes routes;
+            const size_t stop_count = cat.GetStops().size();
+            for (size_t i = 0; i < 100; ++i) {
+                const size_t from = (i * 7919) % stop_count;
+                const size_t to = (i * 104729 + 1) % stop_count;
+                pareto_router.FindRoutes(2 * from, 2 * to, std::numeric_limits<int>::max(), routes);
+            }
+            });
+
+        // поиск по запросу без матрицы: Дейкстра, A* и ALT на одних и тех же парах остановок
+        {
+            const auto& route_graph = transport_router.GetRouteGraph<BusRouteWeight>();
+            const graph::Router<BusRouteWeight> on_demand_router(route_graph, {});
+            const size_t stop_count = cat.GetStops().size();
+            graph::Router<BusRouteWeight>::ShortestPathTree tree;
+            std::vector<graph::EdgeId> edges;
+            Measure(printer, "graph::Router Dijkstra point-to-point"sv, scale, [&] {
+                for (size_t i = 0; i < 100; ++i) {
+                    const graph::VertexId to = 2 * ((i * 104729 + 1) % stop_count);
+                    on_demand_router.BuildShortestPathTree(2 * ((i * 7919) % stop_count), { to }, tree);
+                    on_demand_router.BuildRoute(tree, to, edges);
+                }
+                });
+
+            catalogue::RouteTimeLowerBound lower_bound(transport_router, cat);
+            Measure(printer, "graph::Router A* point-to-point"sv, scale, [&] {
+                for (size_t i = 0; i < 100; ++i) {
+                    const graph::VertexId to = 2 * ((i * 104729 + 1) % stop_count);
+                    lower_bound.SetTarget(to);
+                    on_demand_router.BuildGoalDirectedTree(2 * ((i * 7919) % stop_count), to, lower_bound, tree);
+                    on_demand_router.BuildRoute(tree, to, edges);
+                }
+                });
+
+            catalogue::Landmarks landmarks;
+            Measure(printer, "catalogue::Landmarks::Build"sv, scale, [&] {
+                landmarks = catalogue::Landmarks::Build(transport_router, 8);
+                });
+            catalogue::LandmarkLowerBound landmark_lower_bound(landmarks, transport_router.GetRoutingSettings().bus_wait_time);
+            Measure(printer, "graph::Router ALT point-to-point"sv, scale, [&] {
+                for (size_t i = 0; i < 100; ++i) {
+                    const graph::VertexId to = 2 * ((i * 104729 + 1) % stop_count);
+                    landmark_lower_bound.SetTarget(to);
+                    on_demand_router.BuildGoalDirectedTree(2 * ((i * 7919) % stop_count), to, landmark_lower_bound, tree);
+                    on_demand_router.BuildRoute(tree, to, edges);
+                }
+                });
+
+            // только время маршрута; пары остановок по id справочника
+            catalogue::HubLabels hub_labels;
+            Measure(printer, "catalogue::HubLabels::Build"sv, scale, [&] {
+                hub_labels = catalogue::HubLabels::Build(transport_router, cat);
+                });
+            Measure(printer, "HubLabels::GetRouteTime"sv, scale, [&] {
+                for (size_t i = 0; i < 1000; ++i) {
+                    hub_labels.GetRouteTime((i * 7919) % stop_count, (i * 104729 + 1) % stop_count);
+                }
+                });
+        }
+
+        if (scale > options.router_stop_limit) {
+            printer.PrintSkipped("graph::Router construction"sv, scale);
+            printer.PrintSkipped("graph::Router::BuildRoute"sv, scale);
+            printer.PrintSkipped("Serializer"sv, scale);
+            printer.PrintSkipped("Deserializer"sv, scale);
+            return;
+        }
+
+        const auto& route_graph = transport_router.GetRouteGraph<BusRouteWeight>();
+        Measure(printer, "graph::Router construction"sv, scale, [&route_graph] {
+            graph::Router<BusRouteWeight> router(route_graph);
+            });
+
+        graph::Router<BusRouteWeight> router(route_graph);
+        Measure(printer, "graph::Router::BuildRoute"sv, scale, [&] {
+            // фиксированная последовательность пар остановок
+            const size_t stop_count = cat.GetStops().size();
+            for (size_t i = 0; i < 1000; ++i) {
+                const size_t from = (i * 7919) % stop_count;
+                const size_t to = (i * 104729 + 1) % stop_count;
+                router.BuildRoute(2 * from, 2 * to);
+            }
+            });
+
+        const Serialize::SerializeSettings serialize_settings = reader.ReadSerializeSettings(doc);
+        const catalogue::Timetable timetable;
+        const catalogue::Landmarks landmarks;
+        const catalogue::HubLabels hub_labels;
+        Measure(printer, "Serializer"sv, scale, [&] {
+            Serialize::Serializer serializer(cat, transport_router, reader.GetRenderSettings(), serialize_settings, router, timetable,
+                landmarks, hub_labels);
+            serializer.Save();
+            });
+
+        Measure(printer, "Deserializer"sv, scale, [&] {
+            Serialize::Deserializer deserializer(serialize_settings);
+            catalogue::TransportCatalogue loaded_cat = deserializer.GetTransportCatalogue();
+            catalogue::TransportRouter loaded_transport_router = deserializer.GetTransportRouter(loaded_cat);
+            deserializer.GetRenderSettings();
+            deserializer.GetRouter(loaded_transport_router.GetRouteGraph<BusRouteWeight>());
+            });
+
+        std::filesystem::remove(serialize_settings.file);
+    }
+
+    std::vector<size_t> ParseScales(std::string_view text) {
+        std::vector<size_t> result;
+        while (!text.empty()) {
+            const size_t comma = text.find(',');
+            result.push_back(std::stoul(std::string(text.substr(0, comma))));
+            text.remove_prefix(comma == text.npos ? text.size() : comma + 1);
+        }
+        return result;
+    }
+
+    void PrintUsage(std::ostream& stream = std::cerr) {
+        stream << "Usage: transport_catalogue_benchmark [--scales=1000,10000,100000] [--buses=N]\n"
+            "    [--route-length=N] [--roundtrip-ratio=X] [--distance-density=X] [--seed=N]\n"
+            "    [--router-limit=N] [--emit-base [--base-file=PATH]]\n"sv;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        const size_t eq = arg.find('=');
+        const std::string_view key = arg.substr(0, eq);
+        const std::string value(eq == arg.npos ? ""sv : arg.substr(eq + 1));
+
+        if (key == "--scales"sv) {
+            options.scales = ParseScales(value);
+        } else if (key == "--buses"sv) {
+            options.bus_count = std::stoul(value);
+        } else if (key == "--route-length"sv) {
+            options.city.route_length = std::stoul(value);
+        } else if (key == "--roundtrip-ratio"sv) {
+            options.city.roundtrip_ratio = std::stod(value);
+        } else if (key == "--distance-density"sv) {
+            options.city.distance_density = std::stod(value);
+        } else if (key == "--seed"sv) {
+            options.city.seed = static_cast<uint32_t>(std::stoul(value));
+        } else if (key == "--router-limit"sv) {
+            options.router_stop_limit = std::stoul(value);
+        } else if (key == "--emit-base"sv) {
+            options.emit_base = true;
+        } else if (key == "--base-file"sv) {
+            options.city.serialization_file = value;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (options.emit_base) {
+        // печатает запросы make_base для первого масштаба
+        synthetic::CityParams params = options.city;
+        params.stop_count = options.scales.front();
+        params.bus_count = options.bus_count.value_or(std::max<size_t>(1, params.stop_count / 10));
+        json::Print(synthetic::GenerateBase(params), std::cout);
+        return 0;
+    }
+
+    BenchmarkPrinter printer(std::cout);
+    for (size_t scale : options.scales) {
+        RunBenchmarks(options, scale, printer);
+    }
+}
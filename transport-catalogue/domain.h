@@ -1,15 +1,18 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 
 #include "geo.h"
+#include "ranges.h"
 
 static const double MIN = 1e-6;
 
+// Имена остановок и автобусов хранятся в пуле строк справочника
 struct Stop {
-    std::string name_;
+    std::string_view name_;
     geo::Coordinates cordinates_;
     int id = 0;
 };
@@ -20,10 +23,17 @@ enum class BusType {
     CYCLED
 };
 struct Bus {
-    std::string name_;
+    std::string_view name_;
     std::vector<StopPtr> stops_;
     BusType bus_type_;
     int id = 0;
+
+    // Накопленные расстояния вдоль stops_: элемент i - путь от stops_[0] до stops_[i].
+    // Длина любого участка маршрута - разность двух элементов
+    std::vector<uint64_t> road_forward_;
+    // дорожный путь в обратную сторону, от stops_[i] до stops_[0]; только для некольцевых
+    std::vector<uint64_t> road_backward_;
+    std::vector<double> geo_;
 };
 using BusPtr = const Bus*;
 
@@ -36,8 +46,11 @@ struct BusInfo {
     bool IsEmpty() const;
     bool IsExsists = false;
 };
+// Автобусы остановки в порядке имён, ссылается на данные справочника
+using StopBusesRange = ranges::Range<std::vector<BusPtr>::const_iterator>;
+
 struct StopInfo {
-    std::set<std::string_view> buses_;
+    StopBusesRange buses_;
     bool IsExsists = false;
 };
 
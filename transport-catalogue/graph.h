@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ranges.h"
+#include "memory_stats.h"
 
 #include <cstdlib>
 #include <vector>
@@ -27,12 +28,16 @@ public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
+    // Меняет только вес; построенные по графу Router после этого устаревают
+    void SetEdgeWeight(EdgeId edge_id, const Weight& weight);
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
+    memory_stats::Report GetMemoryStats() const;
+
     // **** for serialization purposes ****
     const std::vector<Edge<Weight>>& GetEdges() const;
     const std::vector<IncidenceList>& GetIncidenceLists() const;
@@ -55,6 +60,11 @@ EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
     return id;
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, const Weight& weight) {
+    edges_.at(edge_id).weight = weight;
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
     return incidence_lists_.size();
@@ -76,6 +86,18 @@ DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
     return ranges::AsRange(incidence_lists_.at(vertex));
 }
 
+template <typename Weight>
+memory_stats::Report DirectedWeightedGraph<Weight>::GetMemoryStats() const {
+    memory_stats::Report report;
+    report.push_back(memory_stats::Collect("edges_", edges_));
+    memory_stats::ContainerStats& incidence_lists = report.emplace_back(
+        memory_stats::Collect("incidence_lists_", incidence_lists_));
+    for (const IncidenceList& list : incidence_lists_) {
+        incidence_lists.heap_bytes += memory_stats::HeapBytes(list);
+    }
+    return report;
+}
+
 template <typename Weight>
 const std::vector<Edge<Weight>>& DirectedWeightedGraph<Weight>::GetEdges() const {
     return edges_;
@@ -0,0 +1,303 @@
+#include "hub_labels.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace catalogue {
+
+    namespace {
+
+        struct Arc {
+            uint32_t to = 0;
+            double time = 0.0;
+        };
+
+        struct LabelEntry {
+            uint32_t hub = 0;
+            double time = 0.0;
+        };
+
+        using Adjacency = std::vector<std::vector<Arc>>;
+        using Labels = std::vector<std::vector<LabelEntry>>;
+
+        // из нескольких рёбер между парой остановок нужно только самое быстрое
+        void RemoveParallelArcs(Adjacency& adjacency) {
+            for (std::vector<Arc>& arcs : adjacency) {
+                std::sort(arcs.begin(), arcs.end(), [](const Arc& lhs, const Arc& rhs) {
+                    return lhs.to < rhs.to || (lhs.to == rhs.to && lhs.time < rhs.time);
+                    });
+                arcs.erase(std::unique(arcs.begin(), arcs.end(), [](const Arc& lhs, const Arc& rhs) {
+                    return lhs.to == rhs.to;
+                    }), arcs.end());
+            }
+        }
+
+        // Порядок хабов: остановки, через которые проходит больше кратчайших путей, раньше.
+        // Из samples остановок выполняются поиски по графу и по обращённому графу, вес остановки -
+        // сумма размеров её поддеревьев в деревьях кратчайших путей, при равенстве - число рёбер
+        std::vector<uint32_t> OrderHubs(const Adjacency& forward, const Adjacency& backward, size_t samples) {
+            const size_t stop_count = forward.size();
+            samples = std::min(samples, stop_count);
+            std::vector<std::vector<uint32_t>> coverage(2 * samples);
+            parallel::ForChunks(coverage.size(), 1, [&](size_t begin, size_t end) {
+                std::vector<double> times;
+                std::vector<uint32_t> parents;
+                std::vector<uint32_t> settled;
+                using QueueItem = std::pair<double, uint32_t>;
+                std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+                for (size_t search = begin; search < end; ++search) {
+                    const Adjacency& adjacency = search < samples ? forward : backward;
+                    const uint32_t root = static_cast<uint32_t>((search % samples) * stop_count / samples);
+                    times.assign(stop_count, std::numeric_limits<double>::infinity());
+                    parents.assign(stop_count, root);
+                    settled.clear();
+                    times[root] = 0.0;
+                    queue.push({ 0.0, root });
+                    while (!queue.empty()) {
+                        const auto [time, stop] = queue.top();
+                        queue.pop();
+                        if (time > times[stop]) {
+                            continue;
+                        }
+                        settled.push_back(stop);
+                        for (const Arc& arc : adjacency[stop]) {
+                            if (time + arc.time < times[arc.to]) {
+                                times[arc.to] = time + arc.time;
+                                parents[arc.to] = stop;
+                                queue.push({ times[arc.to], arc.to });
+                            }
+                        }
+                    }
+                    // потомки закрываются позже предков, поэтому размеры поддеревьев копятся с конца
+                    std::vector<uint32_t>& subtree_sizes = coverage[search];
+                    subtree_sizes.assign(stop_count, 0);
+                    for (auto it = settled.rbegin(); it != settled.rend(); ++it) {
+                        subtree_sizes[*it] += 1;
+                        if (*it != root) {
+                            subtree_sizes[parents[*it]] += subtree_sizes[*it];
+                        }
+                    }
+                }
+                });
+
+            std::vector<uint64_t> scores(stop_count, 0);
+            for (const std::vector<uint32_t>& subtree_sizes : coverage) {
+                for (size_t stop = 0; stop < stop_count; ++stop) {
+                    scores[stop] += subtree_sizes[stop];
+                }
+            }
+            std::vector<uint32_t> order(stop_count);
+            for (uint32_t stop = 0; stop < stop_count; ++stop) {
+                order[stop] = stop;
+            }
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+                if (scores[lhs] != scores[rhs]) {
+                    return scores[lhs] > scores[rhs];
+                }
+                return forward[lhs].size() + backward[lhs].size() > forward[rhs].size() + backward[rhs].size();
+                });
+            return order;
+        }
+
+        void FlattenLabels(const Labels& labels, std::vector<uint32_t>& offsets, std::vector<uint32_t>& hubs,
+            std::vector<double>& times) {
+            size_t total = labels.size();
+            for (const std::vector<LabelEntry>& label : labels) {
+                total += label.size();
+            }
+            offsets.reserve(labels.size() + 1);
+            hubs.reserve(total);
+            times.reserve(total);
+            offsets.push_back(0);
+            for (const std::vector<LabelEntry>& label : labels) {
+                for (const LabelEntry& entry : label) {
+                    hubs.push_back(entry.hub);
+                    times.push_back(entry.time);
+                }
+                hubs.push_back(HubLabels::SENTINEL);
+                times.push_back(std::numeric_limits<double>::infinity());
+                offsets.push_back(static_cast<uint32_t>(hubs.size()));
+            }
+        }
+
+    } // namespace
+
+    HubLabels HubLabels::Build(const TransportRouter& transport_router, const TransportCatalogue& cat) {
+        const graph::DirectedWeightedGraph<BusRouteWeight>& route_graph = transport_router.GetRouteGraph<BusRouteWeight>();
+        const std::deque<StopPtr>& vertex_index_to_stop = transport_router.GetVertexIndexToStop();
+        const size_t stop_count = cat.GetStops().size();
+
+        // граф остановок: из вершины прибытия выходит только ребро ожидания, за ним - поездки
+        Adjacency forward(stop_count);
+        Adjacency backward(stop_count);
+        for (graph::VertexId arrival = 0; arrival < route_graph.GetVertexCount(); arrival += 2) {
+            const uint32_t from = static_cast<uint32_t>(vertex_index_to_stop[arrival]->id);
+            for (const graph::EdgeId wait_edge_id : route_graph.GetIncidentEdges(arrival)) {
+                const graph::Edge<BusRouteWeight>& wait_edge = route_graph.GetEdge(wait_edge_id);
+                for (const graph::EdgeId edge_id : route_graph.GetIncidentEdges(wait_edge.to)) {
+                    const graph::Edge<BusRouteWeight>& edge = route_graph.GetEdge(edge_id);
+                    const uint32_t to = static_cast<uint32_t>(vertex_index_to_stop[edge.to]->id);
+                    if (to != from) {
+                        forward[from].push_back({ to, wait_edge.weight.time + edge.weight.time });
+                        backward[to].push_back({ from, wait_edge.weight.time + edge.weight.time });
+                    }
+                }
+            }
+        }
+        RemoveParallelArcs(forward);
+        RemoveParallelArcs(backward);
+
+        const std::vector<uint32_t> order = OrderHubs(forward, backward, ORDER_SAMPLES);
+
+        // хабы в метках - ранги остановок, поэтому метки растут упорядоченными
+        Labels out_labels(stop_count);
+        Labels in_labels(stop_count);
+        std::vector<double> root_times(stop_count, std::numeric_limits<double>::infinity());
+        std::vector<double> times(stop_count, std::numeric_limits<double>::infinity());
+        std::vector<uint32_t> visited;
+        using QueueItem = std::pair<double, uint32_t>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+        // Дейкстра из root, которая не идёт дальше остановок, время до которых уже даёт пара
+        // root_label и labels[stop]; остальным остановкам добавляет в labels хаб rank
+        auto pruned_search = [&](uint32_t root, uint32_t rank, const Adjacency& adjacency,
+            const std::vector<LabelEntry>& root_label, Labels& labels) {
+            for (const LabelEntry& entry : root_label) {
+                root_times[entry.hub] = entry.time;
+            }
+            times[root] = 0.0;
+            visited.push_back(root);
+            queue.push({ 0.0, root });
+            while (!queue.empty()) {
+                const auto [time, stop] = queue.top();
+                queue.pop();
+                if (time > times[stop]) {
+                    continue;
+                }
+                double covered_time = std::numeric_limits<double>::infinity();
+                for (const LabelEntry& entry : labels[stop]) {
+                    covered_time = std::min(covered_time, root_times[entry.hub] + entry.time);
+                }
+                if (covered_time <= time) {
+                    continue;
+                }
+                labels[stop].push_back({ rank, time });
+                for (const Arc& arc : adjacency[stop]) {
+                    if (time + arc.time < times[arc.to]) {
+                        if (times[arc.to] == std::numeric_limits<double>::infinity()) {
+                            visited.push_back(arc.to);
+                        }
+                        times[arc.to] = time + arc.time;
+                        queue.push({ times[arc.to], arc.to });
+                    }
+                }
+            }
+            for (const uint32_t stop : visited) {
+                times[stop] = std::numeric_limits<double>::infinity();
+            }
+            visited.clear();
+            for (const LabelEntry& entry : root_label) {
+                root_times[entry.hub] = std::numeric_limits<double>::infinity();
+            }
+        };
+
+        for (uint32_t rank = 0; rank < stop_count; ++rank) {
+            const uint32_t root = order[rank];
+            // прямой поиск даёт времена из root - входящие метки, обратный - исходящие
+            pruned_search(root, rank, forward, out_labels[root], in_labels);
+            pruned_search(root, rank, backward, in_labels[root], out_labels);
+        }
+
+        HubLabels result;
+        FlattenLabels(out_labels, result.out_offsets_, result.out_hubs_, result.out_times_);
+        FlattenLabels(in_labels, result.in_offsets_, result.in_hubs_, result.in_times_);
+        return result;
+    }
+
+    bool HubLabels::IsEmpty() const {
+        return out_offsets_.empty();
+    }
+
+    size_t HubLabels::GetStopCount() const {
+        return out_offsets_.empty() ? 0 : out_offsets_.size() - 1;
+    }
+
+    std::optional<double> HubLabels::GetRouteTime(size_t stop_from, size_t stop_to) const {
+        if (stop_from == stop_to) {
+            return 0.0;
+        }
+        const uint32_t* out_hubs = out_hubs_.data() + out_offsets_[stop_from];
+        const double* out_times = out_times_.data() + out_offsets_[stop_from];
+        const uint32_t* in_hubs = in_hubs_.data() + in_offsets_[stop_to];
+        const double* in_times = in_times_.data() + in_offsets_[stop_to];
+
+        // Обе метки кончаются SENTINEL, поэтому слияние не проверяет границы.
+        // Шаг слияния без ветвлений: сдвигается метка с меньшим хабом, при равных - обе
+        double time = std::numeric_limits<double>::infinity();
+        size_t out_index = 0;
+        size_t in_index = 0;
+        uint32_t out_hub = out_hubs[0];
+        uint32_t in_hub = in_hubs[0];
+        while (out_hub != SENTINEL && in_hub != SENTINEL) {
+            const double sum = out_times[out_index] + in_times[in_index];
+            time = out_hub == in_hub && sum < time ? sum : time;
+            out_index += out_hub <= in_hub;
+            in_index += in_hub <= out_hub;
+            out_hub = out_hubs[out_index];
+            in_hub = in_hubs[in_index];
+        }
+        if (time == std::numeric_limits<double>::infinity()) {
+            return std::nullopt;
+        }
+        return time;
+    }
+
+    const std::vector<uint32_t>& HubLabels::GetOutOffsets() const {
+        return out_offsets_;
+    }
+
+    const std::vector<uint32_t>& HubLabels::GetOutHubs() const {
+        return out_hubs_;
+    }
+
+    const std::vector<double>& HubLabels::GetOutTimes() const {
+        return out_times_;
+    }
+
+    const std::vector<uint32_t>& HubLabels::GetInOffsets() const {
+        return in_offsets_;
+    }
+
+    const std::vector<uint32_t>& HubLabels::GetInHubs() const {
+        return in_hubs_;
+    }
+
+    const std::vector<double>& HubLabels::GetInTimes() const {
+        return in_times_;
+    }
+
+    memory_stats::Report HubLabels::GetMemoryStats() const {
+        return {
+            memory_stats::Collect("out_offsets_", out_offsets_),
+            memory_stats::Collect("out_hubs_", out_hubs_),
+            memory_stats::Collect("out_times_", out_times_),
+            memory_stats::Collect("in_offsets_", in_offsets_),
+            memory_stats::Collect("in_hubs_", in_hubs_),
+            memory_stats::Collect("in_times_", in_times_)
+        };
+    }
+
+    void HubLabels::Set(std::vector<uint32_t>&& out_offsets, std::vector<uint32_t>&& out_hubs, std::vector<double>&& out_times,
+        std::vector<uint32_t>&& in_offsets, std::vector<uint32_t>&& in_hubs, std::vector<double>&& in_times) {
+        out_offsets_ = std::move(out_offsets);
+        out_hubs_ = std::move(out_hubs);
+        out_times_ = std::move(out_times);
+        in_offsets_ = std::move(in_offsets);
+        in_hubs_ = std::move(in_hubs);
+        in_times_ = std::move(in_times);
+    }
+
+} // namespace catalogue
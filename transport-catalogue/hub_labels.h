@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "domain.h"
+#include "memory_stats.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+namespace catalogue {
+
+    // Метки хабов (hub labeling) для времени маршрута между остановками без восстановления пути.
+    // У каждой остановки есть исходящая метка - хабы, до которых из неё можно доехать, с временами,
+    // и входящая - хабы, из которых можно доехать до неё. Время маршрута s -> t - минимум суммы
+    // времён по общим хабам исходящей метки s и входящей метки t
+    class HubLabels {
+    public:
+        // конец каждой метки; больше номера любого хаба
+        static constexpr uint32_t SENTINEL = UINT32_MAX;
+
+        HubLabels() = default;
+
+        // Строит метки поиском с отсечениями (pruned landmark labeling) на графе остановок,
+        // в котором ожидание и поездка слиты в одно ребро. Хабы перебираются по убыванию
+        // числа кратчайших путей через остановку, оценённого по ORDER_SAMPLES деревьям путей
+        static HubLabels Build(const TransportRouter& transport_router, const TransportCatalogue& cat);
+
+        bool IsEmpty() const;
+        size_t GetStopCount() const;
+
+        // Время маршрута между остановками по их id в справочнике; nullopt, если доехать нельзя
+        std::optional<double> GetRouteTime(size_t stop_from, size_t stop_to) const;
+
+        // метки остановки i - [offsets[i], offsets[i + 1]) в hubs и times, последний хаб - SENTINEL
+        const std::vector<uint32_t>& GetOutOffsets() const;
+        const std::vector<uint32_t>& GetOutHubs() const;
+        const std::vector<double>& GetOutTimes() const;
+        const std::vector<uint32_t>& GetInOffsets() const;
+        const std::vector<uint32_t>& GetInHubs() const;
+        const std::vector<double>& GetInTimes() const;
+
+        memory_stats::Report GetMemoryStats() const;
+
+        // serialization
+        void Set(std::vector<uint32_t>&& out_offsets, std::vector<uint32_t>&& out_hubs, std::vector<double>&& out_times,
+            std::vector<uint32_t>&& in_offsets, std::vector<uint32_t>&& in_hubs, std::vector<double>&& in_times);
+
+    private:
+        static constexpr size_t ORDER_SAMPLES = 64;
+
+        // Метки всех остановок подряд; хабы и времена в отдельных массивах,
+        // чтобы слияние меток читало хабы последовательно
+        std::vector<uint32_t> out_offsets_;
+        std::vector<uint32_t> out_hubs_;
+        std::vector<double> out_times_;
+        std::vector<uint32_t> in_offsets_;
+        std::vector<uint32_t> in_hubs_;
+        std::vector<double> in_times_;
+    };
+
+} // namespace catalogue
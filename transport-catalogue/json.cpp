@@ -224,15 +224,23 @@ struct PrintContext {
     std::ostream& out;
     int indent_step = 4;
     int indent = 0;
+    // без пробелов и переводов строк
+    bool compact = false;
 
     void PrintIndent() const {
-        for (int i = 0; i < indent; ++i) {
+        for (int i = 0; !compact && i < indent; ++i) {
             out.put(' ');
         }
     }
 
+    void PrintNewLine() const {
+        if (!compact) {
+            out.put('\n');
+        }
+    }
+
     PrintContext Indented() const {
-        return {out, indent_step, indent_step + indent};
+        return {out, indent_step, indent_step + indent, compact};
     }
 };
 
@@ -289,19 +297,21 @@ void PrintValue<bool>(const bool& value, const PrintContext& ctx) {
 template <>
 void PrintValue<Array>(const Array& nodes, const PrintContext& ctx) {
     std::ostream& out = ctx.out;
-    out << "[\n"sv;
+    out.put('[');
+    ctx.PrintNewLine();
     bool first = true;
     auto inner_ctx = ctx.Indented();
     for (const Node& node : nodes) {
         if (first) {
             first = false;
         } else {
-            out << ",\n"sv;
+            out.put(',');
+            ctx.PrintNewLine();
         }
         inner_ctx.PrintIndent();
         PrintNode(node, inner_ctx);
     }
-    out.put('\n');
+    ctx.PrintNewLine();
     ctx.PrintIndent();
     out.put(']');
 }
@@ -309,21 +319,23 @@ void PrintValue<Array>(const Array& nodes, const PrintContext& ctx) {
 template <>
 void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
     std::ostream& out = ctx.out;
-    out << "{\n"sv;
+    out.put('{');
+    ctx.PrintNewLine();
     bool first = true;
     auto inner_ctx = ctx.Indented();
     for (const auto& [key, node] : nodes) {
         if (first) {
             first = false;
         } else {
-            out << ",\n"sv;
+            out.put(',');
+            ctx.PrintNewLine();
         }
         inner_ctx.PrintIndent();
         PrintString(key, ctx.out);
-        out << ": "sv;
+        out << (ctx.compact ? ":"sv : ": "sv);
         PrintNode(node, inner_ctx);
     }
-    out.put('\n');
+    ctx.PrintNewLine();
     ctx.PrintIndent();
     out.put('}');
 }
@@ -346,4 +358,8 @@ void Print(const Document& doc, std::ostream& output) {
     PrintNode(doc.GetRoot(), PrintContext{output});
 }
 
+void PrintCompact(const Document& doc, std::ostream& output) {
+    PrintNode(doc.GetRoot(), PrintContext{output, 0, 0, true});
+}
+
 }  // namespace json
\ No newline at end of file
@@ -164,5 +164,7 @@ inline bool operator!=(const Document& lhs, const Document& rhs) {
 Document Load(std::istream& input);
 
 void Print(const Document& doc, std::ostream& output);
+// Печатает документ без пробелов и переводов строк
+void PrintCompact(const Document& doc, std::ostream& output);
 
 }  // namespace json
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "json_binary.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace json {
+
+namespace {
+
+// Дописывает value в out в порядке big-endian
+template <typename Int>
+void AppendBigEndian(std::string& out, Int value) {
+    for (int shift = (sizeof(Int) - 1) * 8; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((static_cast<uint64_t>(value) >> shift) & 0xFF));
+    }
+}
+
+void AppendDouble(std::string& out, double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    AppendBigEndian(out, bits);
+}
+
+class CborEncoder {
+public:
+    explicit CborEncoder(std::string& out)
+        : out_(out) {
+    }
+
+    void Encode(const Node& node) {
+        std::visit([this](const auto& value) { EncodeValue(value); }, node.GetValue());
+    }
+
+private:
+    std::string& out_;
+
+    // заголовок элемента: старший тип и аргумент в кратчайшей форме
+    void AppendHead(uint8_t major_type, uint64_t argument) {
+        const uint8_t major = static_cast<uint8_t>(major_type << 5);
+        if (argument < 24) {
+            out_.push_back(static_cast<char>(major | argument));
+        } else if (argument <= UINT8_MAX) {
+            out_.push_back(static_cast<char>(major | 24));
+            AppendBigEndian(out_, static_cast<uint8_t>(argument));
+        } else if (argument <= UINT16_MAX) {
+            out_.push_back(static_cast<char>(major | 25));
+            AppendBigEndian(out_, static_cast<uint16_t>(argument));
+        } else if (argument <= UINT32_MAX) {
+            out_.push_back(static_cast<char>(major | 26));
+            AppendBigEndian(out_, static_cast<uint32_t>(argument));
+        } else {
+            out_.push_back(static_cast<char>(major | 27));
+            AppendBigEndian(out_, argument);
+        }
+    }
+
+    void EncodeValue(std::nullptr_t) {
+        out_.push_back(static_cast<char>(0xF6));
+    }
+
+    void EncodeValue(bool value) {
+        out_.push_back(static_cast<char>(value ? 0xF5 : 0xF4));
+    }
+
+    void EncodeValue(int value) {
+        if (value >= 0) {
+            AppendHead(0, static_cast<uint64_t>(value));
+        } else {
+            // отрицательное n кодируется как -1 - n
+            AppendHead(1, static_cast<uint64_t>(-1 - static_cast<int64_t>(value)));
+        }
+    }
+
+    void EncodeValue(double value) {
+        out_.push_back(static_cast<char>(0xFB));
+        AppendDouble(out_, value);
+    }
+
+    void EncodeValue(const std::string& value) {
+        AppendHead(3, value.size());
+        out_.append(value);
+    }
+
+    void EncodeValue(const Array& nodes) {
+        AppendHead(4, nodes.size());
+        for (const Node& node : nodes) {
+            Encode(node);
+        }
+    }
+
+    void EncodeValue(const Dict& nodes) {
+        AppendHead(5, nodes.size());
+        for (const auto& [key, node] : nodes) {
+            EncodeValue(key);
+            Encode(node);
+        }
+    }
+};
+
+class MessagePackEncoder {
+public:
+    explicit MessagePackEncoder(std::string& out)
+        : out_(out) {
+    }
+
+    void Encode(const Node& node) {
+        std::visit([this](const auto& value) { EncodeValue(value); }, node.GetValue());
+    }
+
+private:
+    std::string& out_;
+
+    void AppendMarker(uint8_t marker) {
+        out_.push_back(static_cast<char>(marker));
+    }
+
+    // заголовок строки или контейнера: fix-форма для малых размеров, иначе 8/16/32 бита
+    void AppendSizeHead(size_t size, uint8_t fix_marker, size_t fix_limit,
+        int marker_8, uint8_t marker_16, uint8_t marker_32) {
+        if (size < fix_limit) {
+            AppendMarker(static_cast<uint8_t>(fix_marker | size));
+        } else if (marker_8 >= 0 && size <= UINT8_MAX) {
+            AppendMarker(static_cast<uint8_t>(marker_8));
+            AppendBigEndian(out_, static_cast<uint8_t>(size));
+        } else if (size <= UINT16_MAX) {
+            AppendMarker(marker_16);
+            AppendBigEndian(out_, static_cast<uint16_t>(size));
+        } else {
+            AppendMarker(marker_32);
+            AppendBigEndian(out_, static_cast<uint32_t>(size));
+        }
+    }
+
+    void EncodeValue(std::nullptr_t) {
+        AppendMarker(0xC0);
+    }
+
+    void EncodeValue(bool value) {
+        AppendMarker(value ? 0xC3 : 0xC2);
+    }
+
+    void EncodeValue(int value) {
+        if (value >= 0 && value < 128) {
+            AppendMarker(static_cast<uint8_t>(value));
+        } else if (value < 0 && value >= -32) {
+            AppendMarker(static_cast<uint8_t>(value));
+        } else if (value >= 0) {
+            if (value <= UINT8_MAX) {
+                AppendMarker(0xCC);
+                AppendBigEndian(out_, static_cast<uint8_t>(value));
+            } else if (value <= UINT16_MAX) {
+                AppendMarker(0xCD);
+                AppendBigEndian(out_, static_cast<uint16_t>(value));
+            } else {
+                AppendMarker(0xCE);
+                AppendBigEndian(out_, static_cast<uint32_t>(value));
+            }
+        } else if (value >= INT8_MIN) {
+            AppendMarker(0xD0);
+            AppendBigEndian(out_, static_cast<int8_t>(value));
+        } else if (value >= INT16_MIN) {
+            AppendMarker(0xD1);
+            AppendBigEndian(out_, static_cast<int16_t>(value));
+        } else {
+            AppendMarker(0xD2);
+            AppendBigEndian(out_, static_cast<int32_t>(value));
+        }
+    }
+
+    void EncodeValue(double value) {
+        AppendMarker(0xCB);
+        AppendDouble(out_, value);
+    }
+
+    void EncodeValue(const std::string& value) {
+        AppendSizeHead(value.size(), 0xA0, 32, 0xD9, 0xDA, 0xDB);
+        out_.append(value);
+    }
+
+    void EncodeValue(const Array& nodes) {
+        AppendSizeHead(nodes.size(), 0x90, 16, -1, 0xDC, 0xDD);
+        for (const Node& node : nodes) {
+            Encode(node);
+        }
+    }
+
+    void EncodeValue(const Dict& nodes) {
+        AppendSizeHead(nodes.size(), 0x80, 16, -1, 0xDE, 0xDF);
+        for (const auto& [key, node] : nodes) {
+            EncodeValue(key);
+            Encode(node);
+        }
+    }
+};
+
+}  // namespace
+
+void PrintCbor(const Document& doc, std::ostream& output) {
+    std::string out;
+    CborEncoder(out).Encode(doc.GetRoot());
+    output.write(out.data(), static_cast<std::streamsize>(out.size()));
+}
+
+void PrintMessagePack(const Document& doc, std::ostream& output) {
+    std::string out;
+    MessagePackEncoder(out).Encode(doc.GetRoot());
+    output.write(out.data(), static_cast<std::streamsize>(out.size()));
+}
+
+}  // namespace json
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <iostream>
+
+#include "json.h"
+
+namespace json {
+
+// Кодирует документ в CBOR (RFC 8949). Целые записываются в кратчайшей форме,
+// вещественные - как float64 без потери точности
+void PrintCbor(const Document& doc, std::ostream& output);
+
+// Кодирует документ в MessagePack с теми же правилами для чисел
+void PrintMessagePack(const Document& doc, std::ostream& output);
+
+}  // namespace json
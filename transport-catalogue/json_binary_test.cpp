@@ -0,0 +1,296 @@
+#include "json.h"
+#include "json_binary.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+    // Минимальные декодеры CBOR и MessagePack: понимают ровно то подмножество,
+    // которое пишут PrintCbor и PrintMessagePack
+    class BinaryReader {
+    public:
+        explicit BinaryReader(const std::string& data)
+            : data_(data) {
+        }
+
+        bool AtEnd() const {
+            return pos_ == data_.size();
+        }
+
+        uint8_t ReadByte() {
+            if (pos_ >= data_.size()) {
+                throw std::runtime_error("Unexpected end of data"s);
+            }
+            return static_cast<uint8_t>(data_[pos_++]);
+        }
+
+        // целое без знака из size байтов в порядке big-endian
+        uint64_t ReadUint(size_t size) {
+            uint64_t result = 0;
+            for (size_t i = 0; i < size; ++i) {
+                result = (result << 8) | ReadByte();
+            }
+            return result;
+        }
+
+        double ReadDouble() {
+            const uint64_t bits = ReadUint(8);
+            double result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        std::string ReadString(uint64_t size) {
+            if (size > data_.size() - pos_) {
+                throw std::runtime_error("Unexpected end of data"s);
+            }
+            std::string result = data_.substr(pos_, size);
+            pos_ += size;
+            return result;
+        }
+
+    private:
+        const std::string& data_;
+        size_t pos_ = 0;
+    };
+
+    json::Node MakeInt(int64_t value) {
+        if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+            throw std::runtime_error("Integer out of range"s);
+        }
+        return json::Node{ static_cast<int>(value) };
+    }
+
+    uint64_t ReadCborArgument(BinaryReader& reader, uint8_t info) {
+        if (info < 24) {
+            return info;
+        }
+        switch (info) {
+            case 24: return reader.ReadUint(1);
+            case 25: return reader.ReadUint(2);
+            case 26: return reader.ReadUint(4);
+            case 27: return reader.ReadUint(8);
+        }
+        throw std::runtime_error("Unsupported CBOR argument"s);
+    }
+
+    json::Node ReadCborNode(BinaryReader& reader) {
+        const uint8_t initial = reader.ReadByte();
+        const uint8_t major = initial >> 5;
+        const uint8_t info = initial & 0x1F;
+        if (major == 7) {
+            switch (info) {
+                case 20: return json::Node{ false };
+                case 21: return json::Node{ true };
+                case 22: return json::Node{ nullptr };
+                case 27: return json::Node{ reader.ReadDouble() };
+            }
+            throw std::runtime_error("Unsupported CBOR simple value"s);
+        }
+
+        const uint64_t argument = ReadCborArgument(reader, info);
+        switch (major) {
+            case 0:
+                return MakeInt(static_cast<int64_t>(argument));
+            case 1:
+                return MakeInt(-1 - static_cast<int64_t>(argument));
+            case 3:
+                return json::Node{ reader.ReadString(argument) };
+            case 4: {
+                json::Array array;
+                for (uint64_t i = 0; i < argument; ++i) {
+                    array.push_back(ReadCborNode(reader));
+                }
+                return json::Node{ std::move(array) };
+            }
+            case 5: {
+                json::Dict dict;
+                for (uint64_t i = 0; i < argument; ++i) {
+                    json::Node key = ReadCborNode(reader);
+                    dict.emplace(key.AsString(), ReadCborNode(reader));
+                }
+                return json::Node{ std::move(dict) };
+            }
+        }
+        throw std::runtime_error("Unsupported CBOR major type"s);
+    }
+
+    json::Node ReadMessagePackNode(BinaryReader& reader);
+
+    json::Node ReadMessagePackArray(BinaryReader& reader, uint64_t size) {
+        json::Array array;
+        for (uint64_t i = 0; i < size; ++i) {
+            array.push_back(ReadMessagePackNode(reader));
+        }
+        return json::Node{ std::move(array) };
+    }
+
+    json::Node ReadMessagePackDict(BinaryReader& reader, uint64_t size) {
+        json::Dict dict;
+        for (uint64_t i = 0; i < size; ++i) {
+            json::Node key = ReadMessagePackNode(reader);
+            dict.emplace(key.AsString(), ReadMessagePackNode(reader));
+        }
+        return json::Node{ std::move(dict) };
+    }
+
+    json::Node ReadMessagePackNode(BinaryReader& reader) {
+        const uint8_t marker = reader.ReadByte();
+        if (marker <= 0x7F) {
+            return MakeInt(marker);
+        }
+        if (marker >= 0xE0) {
+            return MakeInt(static_cast<int8_t>(marker));
+        }
+        if ((marker & 0xE0) == 0xA0) {
+            return json::Node{ reader.ReadString(marker & 0x1F) };
+        }
+        if ((marker & 0xF0) == 0x90) {
+            return ReadMessagePackArray(reader, marker & 0x0F);
+        }
+        if ((marker & 0xF0) == 0x80) {
+            return ReadMessagePackDict(reader, marker & 0x0F);
+        }
+        switch (marker) {
+            case 0xC0: return json::Node{ nullptr };
+            case 0xC2: return json::Node{ false };
+            case 0xC3: return json::Node{ true };
+            case 0xCB: return json::Node{ reader.ReadDouble() };
+            case 0xCC: return MakeInt(reader.ReadUint(1));
+            case 0xCD: return MakeInt(reader.ReadUint(2));
+            case 0xCE: return MakeInt(reader.ReadUint(4));
+            case 0xD0: return MakeInt(static_cast<int8_t>(reader.ReadUint(1)));
+            case 0xD1: return MakeInt(static_cast<int16_t>(reader.ReadUint(2)));
+            case 0xD2: return MakeInt(static_cast<int32_t>(reader.ReadUint(4)));
+            case 0xD9: return json::Node{ reader.ReadString(reader.ReadUint(1)) };
+            case 0xDA: return json::Node{ reader.ReadString(reader.ReadUint(2)) };
+            case 0xDB: return json::Node{ reader.ReadString(reader.ReadUint(4)) };
+            case 0xDC: return ReadMessagePackArray(reader, reader.ReadUint(2));
+            case 0xDD: return ReadMessagePackArray(reader, reader.ReadUint(4));
+            case 0xDE: return ReadMessagePackDict(reader, reader.ReadUint(2));
+            case 0xDF: return ReadMessagePackDict(reader, reader.ReadUint(4));
+        }
+        throw std::runtime_error("Unsupported MessagePack marker"s);
+    }
+
+    template <typename ReadNode>
+    json::Document DecodeAll(const std::string& data, ReadNode read_node) {
+        BinaryReader reader(data);
+        json::Node root = read_node(reader);
+        if (!reader.AtEnd()) {
+            throw std::runtime_error("Trailing data"s);
+        }
+        return json::Document{ std::move(root) };
+    }
+
+    json::Document ThroughJson(const json::Document& doc) {
+        std::stringstream text;
+        json::Print(doc, text);
+        return json::Load(text);
+    }
+
+    json::Document ThroughCbor(const json::Document& doc) {
+        std::ostringstream data;
+        json::PrintCbor(doc, data);
+        return DecodeAll(data.str(), ReadCborNode);
+    }
+
+    json::Document ThroughMessagePack(const json::Document& doc) {
+        std::ostringstream data;
+        json::PrintMessagePack(doc, data);
+        return DecodeAll(data.str(), ReadMessagePackNode);
+    }
+
+    std::string ToText(const json::Document& doc) {
+        std::ostringstream text;
+        json::PrintCompact(doc, text);
+        return text.str();
+    }
+
+    // Документы, которые без потерь проходят через текстовый JSON: вещественные
+    // не длиннее шести значащих цифр и не целые, иначе Load прочитает их как int
+    std::vector<std::pair<std::string, json::Document>> MakeDocuments() {
+        const std::string long_string(300, 'x');
+        std::vector<std::pair<std::string, json::Document>> documents;
+        documents.emplace_back("null"s, json::Document{ json::Node{ nullptr } });
+        documents.emplace_back("bools"s, json::Document{ json::Array{ true, false } });
+        documents.emplace_back("empty array"s, json::Document{ json::Array{} });
+        documents.emplace_back("empty dict"s, json::Document{ json::Dict{} });
+        documents.emplace_back("nested empty"s, json::Document{ json::Array{
+            json::Array{}, json::Dict{}, json::Dict{ { "a"s, json::Array{} }, { "b"s, json::Dict{} } } } });
+        documents.emplace_back("escapes"s, json::Document{ json::Array{
+            ""s, "quote \" and backslash \\"s, "line\nfeed\r\n"s, "tab\there"s,
+            "\xD0\x9C\xD0\xB0\xD1\x80\xD1\x88\xD1\x80\xD1\x83\xD1\x82"s, long_string } });
+        documents.emplace_back("escaped keys"s, json::Document{ json::Dict{
+            { "key \"quoted\""s, 1 }, { "back\\slash"s, 2 }, { "new\nline"s, 3 } } });
+        documents.emplace_back("ints"s, json::Document{ json::Array{
+            0, 1, 23, 24, 127, 128, 255, 256, 65535, 65536,
+            -1, -24, -25, -32, -33, -128, -129, -32768, -32769,
+            std::numeric_limits<int>::max(), std::numeric_limits<int>::min() } });
+        documents.emplace_back("doubles"s, json::Document{ json::Array{
+            0.5, -0.5, 3.14159, -2.71828, 1.5e+100, -1.25e-100, 1234.5, 0.001 } });
+        documents.emplace_back("request"s, json::Document{ json::Array{ json::Dict{
+            { "request_id"s, 42 },
+            { "total_time"s, 11.235 },
+            { "items"s, json::Array{
+                json::Dict{ { "type"s, "Wait"s }, { "stop_name"s, "Biryulyovo Zapadnoye"s }, { "time"s, 6 } },
+                json::Dict{ { "type"s, "Bus"s }, { "bus"s, "297"s }, { "span_count"s, 2 }, { "time"s, 5.235 } } } },
+            { "error_message"s, nullptr } } } });
+
+        json::Array wide;
+        for (int i = 0; i < 70000; ++i) {
+            wide.emplace_back(i % 3 == 0 ? json::Node{ i } : json::Node{ "s"s + std::to_string(i % 7) });
+        }
+        documents.emplace_back("wide array"s, json::Document{ std::move(wide) });
+
+        json::Dict wide_dict;
+        for (int i = 0; i < 300; ++i) {
+            wide_dict.emplace("k"s + std::to_string(i), json::Array{});
+        }
+        documents.emplace_back("wide dict"s, json::Document{ std::move(wide_dict) });
+        return documents;
+    }
+
+} // namespace
+
+int main() {
+    int failures = 0;
+    for (const auto& [name, doc] : MakeDocuments()) {
+        try {
+            const json::Document from_json = ThroughJson(doc);
+            const json::Document from_cbor = ThroughCbor(doc);
+            const json::Document from_msgpack = ThroughMessagePack(doc);
+            if (from_json != doc) {
+                std::cerr << name << ": JSON round trip differs: "sv << ToText(from_json) << std::endl;
+                ++failures;
+            }
+            if (from_cbor != from_json) {
+                std::cerr << name << ": CBOR differs from JSON: "sv << ToText(from_cbor) << std::endl;
+                ++failures;
+            }
+            if (from_msgpack != from_json) {
+                std::cerr << name << ": MessagePack differs from JSON: "sv << ToText(from_msgpack) << std::endl;
+                ++failures;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << name << ": "sv << e.what() << std::endl;
+            ++failures;
+        }
+    }
+
+    if (failures != 0) {
+        std::cerr << failures << " failure(s)"sv << std::endl;
+        return 1;
+    }
+    std::cout << "OK"sv << std::endl;
+    return 0;
+}
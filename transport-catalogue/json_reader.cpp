@@ -3,8 +3,8 @@
 using namespace std::literals;
 
 namespace json_reader {
-    void JsonReader::ReadBaseRequests(json::Document document) {
-        json::Array base_requests = document.GetRoot().AsDict().at("base_requests").AsArray();
+    void JsonReader::ReadBaseRequests(const json::Document& document) {
+        const json::Array& base_requests = document.GetRoot().AsDict().at("base_requests").AsArray();
         for (const json::Node& base_request : base_requests) {
             assert(base_request.IsDict());
             assert(base_request.AsDict().count("type") != 0);
@@ -22,22 +22,32 @@ namespace json_reader {
 
     void JsonReader::AddStopBaseRequest(const json::Node& request) {
         AddStopRequest add_stop_request{};
-        add_stop_request.cordinates.lat = request.AsDict().at("latitude").AsDouble();
-        add_stop_request.cordinates.lng = request.AsDict().at("longitude").AsDouble();
+        add_stop_request.coordinates.lat = request.AsDict().at("latitude").AsDouble();
+        add_stop_request.coordinates.lng = request.AsDict().at("longitude").AsDouble();
         add_stop_request.name = request.AsDict().at("name").AsString();
         const json::Dict& road_distances = request.AsDict().at("road_distances").AsDict();
+        add_stop_request.road_distances.reserve(road_distances.size());
         for (const auto& road_distance : road_distances) {
-            add_stop_request.distances[road_distance.first] = road_distance.second.AsInt();
+            add_stop_request.road_distances.emplace_back(road_distance.first, road_distance.second.AsInt());
         }
         add_stop_requests_.push_back(std::move(add_stop_request));
     }
     void JsonReader::AddBusBaseRequest(const json::Node& request) {
         AddBusRequest add_bus_request{};
         add_bus_request.name = request.AsDict().at("name").AsString();
-        add_bus_request.is_roundtrip = request.AsDict().at("is_roundtrip").AsBool();
+        add_bus_request.type = request.AsDict().at("is_roundtrip").AsBool() ? BusType::CYCLED : BusType::ORDINARY;
         const json::Array& stops = request.AsDict().at("stops").AsArray();
+        add_bus_request.stops.reserve(stops.size());
         for (const auto& stop : stops) {
-            add_bus_request.stops.push_back(std::move(stop.AsString()));
+            add_bus_request.stops.push_back(stop.AsString());
+        }
+        if (const auto it = request.AsDict().find("departures"); it != request.AsDict().end()) {
+            catalogue::BusTripsDescription& bus_trips = bus_trips_requests_.emplace_back();
+            bus_trips.bus_name = add_bus_request.name;
+            bus_trips.departures.reserve(it->second.AsArray().size());
+            for (const json::Node& departure : it->second.AsArray()) {
+                bus_trips.departures.push_back(departure.AsDouble());
+            }
         }
         add_bus_requests_.push_back(std::move(add_bus_request));
     }
@@ -67,6 +77,19 @@ namespace json_reader {
         settings.underlayer_width = json_settings.AsDict().at("underlayer_width").AsDouble();
         settings.width = json_settings.AsDict().at("width").AsDouble();
 
+        if (const auto it = json_settings.AsDict().find("simplify_tolerance"); it != json_settings.AsDict().end()) {
+            settings.simplify_tolerance = it->second.AsDouble();
+        }
+        if (const auto it = json_settings.AsDict().find("zoom_levels"); it != json_settings.AsDict().end()) {
+            for (const json::Node& zoom : it->second.AsArray()) {
+                // на масштаб делится допуск упрощения линий, поэтому он строго положительный
+                if (!(zoom.AsDouble() > 0.0)) {
+                    throw std::logic_error("bad zoom_levels");
+                }
+                settings.zoom_levels.push_back(zoom.AsDouble());
+            }
+        }
+
         return settings;
     }
 
@@ -104,10 +127,10 @@ namespace json_reader {
     }
 
     JsonReader::JsonReader(json::Document document)
-        : document_(document)
+        : document_(std::move(document))
     {
-        if (document.GetRoot().AsDict().count("base_requests")) {
-            ReadBaseRequests(document);
+        if (document_.GetRoot().AsDict().count("base_requests")) {
+            ReadBaseRequests(document_);
         }
     }
 
@@ -115,40 +138,207 @@ namespace json_reader {
         return ReadRenderSettingsFromJSON(document_);
     }
 
-    json::Document JsonReader::ProcessStatRequests(RequestHandler& handler) {
-        json::Array answers_array{};
-
-        json::Array stat_requests = document_.GetRoot().AsDict().at("stat_requests").AsArray();
+    namespace {
+        // Всё, от чего зависит ответ на запрос, кроме id. Числовые поля хранятся раздельно,
+        // отсутствующее поле не совпадает ни с каким значением
+        struct StatRequestKey {
+            std::string_view type;
+            std::string_view name;
+            std::string_view from;
+            std::string_view to;
+            // Map; без zoom карта рисуется с масштабом 1
+            double zoom = 1.0;
+            // Isochrone
+            std::optional<double> max_time;
+            // ScheduledRoute
+            std::optional<double> departure_time;
+            // ParetoRoute; без max_boardings число посадок не ограничено
+            std::optional<int> max_boardings;
+
+            bool operator==(const StatRequestKey& other) const {
+                return std::tie(type, name, from, to, zoom, max_time, departure_time, max_boardings)
+                    == std::tie(other.type, other.name, other.from, other.to, other.zoom, other.max_time,
+                        other.departure_time, other.max_boardings);
+            }
+        };
 
-        for (const auto& stat_request : stat_requests) {
-            std::string_view request_type = stat_request.AsDict().at("type").AsString();
-            if (request_type == "Bus"sv) {
+        struct StatRequestKeyHasher {
+            size_t operator()(const StatRequestKey& key) const {
+                std::hash<std::string_view> hasher;
+                std::hash<std::optional<double>> optional_hasher;
+                return hasher(key.type) + 37 * hasher(key.name) + 37 * 37 * hasher(key.from)
+                    + 37 * 37 * 37 * hasher(key.to) + std::hash<double>()(key.zoom)
+                    + 41 * optional_hasher(key.max_time) + 41 * 41 * optional_hasher(key.departure_time)
+                    + 41 * 41 * 41 * std::hash<std::optional<int>>()(key.max_boardings);
+            }
+        };
 
-                ProcessBusStatRequest(handler, stat_request, answers_array);
+        StatRequestKey MakeStatRequestKey(const json::Dict& request) {
+            auto get_string = [&request](const std::string& field) {
+                const auto it = request.find(field);
+                return it == request.end() ? std::string_view{} : std::string_view(it->second.AsString());
+            };
+            auto get_number = [&request](const std::string& field) -> std::optional<double> {
+                const auto it = request.find(field);
+                if (it == request.end()) {
+                    return std::nullopt;
+                }
+                return it->second.AsDouble();
+            };
+            const auto max_boardings = request.find("max_boardings");
+            return {
+                request.at("type").AsString(),
+                get_string("name"),
+                get_string("from"),
+                get_string("to"),
+                get_number("zoom").value_or(1.0),
+                get_number("max_time"),
+                get_number("departure_time"),
+                max_boardings == request.end() ? std::nullopt : std::optional<int>(max_boardings->second.AsInt())
+            };
+        }
+    } // namespace
+
+    JsonReader::StatRequestsNeeds JsonReader::ScanStatRequests() const {
+        StatRequestsNeeds needs;
+        for (const json::Node& stat_request : document_.GetRoot().AsDict().at("stat_requests").AsArray()) {
+            const std::string& request_type = stat_request.AsDict().at("type").AsString();
+            if (request_type == "Route"sv) {
+                needs.route_graph = true;
+                needs.router = true;
+            }
+            else if (request_type == "Isochrone"sv || request_type == "ParetoRoute"sv) {
+                needs.route_graph = true;
+            }
+            else if (request_type == "Map"sv) {
+                needs.map = true;
+            }
+            else if (request_type == "ScheduledRoute"sv) {
+                needs.timetable = true;
+            }
+            else if (request_type == "RouteTime"sv) {
+                needs.hub_labels = true;
+            }
+        }
+        return needs;
+    }
 
+    json::Document JsonReader::ProcessStatRequests(RequestHandler& handler) {
+        const json::Array& stat_requests = document_.GetRoot().AsDict().at("stat_requests").AsArray();
+
+        // одинаковые запросы с разными id вычисляются один раз, ответ копируется с заменой request_id.
+        // same_request[i] - индекс первого запроса, совпадающего с i. Ключи ссылаются на строки document_
+        std::vector<size_t> same_request(stat_requests.size());
+        {
+            std::unordered_map<StatRequestKey, size_t, StatRequestKeyHasher> request_by_key;
+            request_by_key.reserve(stat_requests.size());
+            for (size_t i = 0; i < stat_requests.size(); ++i) {
+                same_request[i] = request_by_key.emplace(MakeStatRequestKey(stat_requests[i].AsDict()), i).first->second;
             }
-            else if (request_type == "Stop"sv) {
+        }
 
-                ProcessStopInfoRequest(handler, stat_request, answers_array);
+        json::Array answers_array(stat_requests.size());
+        if (handler.IsRouteSearchOnDemand()) {
+            ProcessRouteRequestsByOrigin(handler, stat_requests, same_request, answers_array);
+        }
 
+        json::Array answer_buffer;
+        for (size_t i = 0; i < stat_requests.size(); ++i) {
+            if (same_request[i] != i) {
+                json::Node answer = answers_array[same_request[i]];
+                answer.AsDict().at("request_id") = stat_requests[i].AsDict().at("id").AsInt();
+                answers_array[i] = std::move(answer);
             }
-            else if (request_type == "Map"sv) {
+            else if (answers_array[i].IsNull()) {
+                ProcessStatRequest(handler, stat_requests[i], answer_buffer);
+                answers_array[i] = std::move(answer_buffer.back());
+                answer_buffer.clear();
+            }
+        }
 
-                ProcessMapRequest(handler, stat_request, answers_array);
+        return json::Document{ std::move(answers_array) };
+    }
 
+    void JsonReader::ProcessRouteRequestsByOrigin(RequestHandler& handler, const json::Array& stat_requests,
+        const std::vector<size_t>& same_request, json::Array& answers_array) {
+        // группы запросов в порядке первого появления остановки отправления
+        std::unordered_map<std::string_view, size_t> group_by_origin;
+        std::vector<std::vector<size_t>> groups;
+        for (size_t i = 0; i < stat_requests.size(); ++i) {
+            const json::Dict& request = stat_requests[i].AsDict();
+            if (same_request[i] != i || request.at("type").AsString() != "Route"sv) {
+                continue;
             }
-            else if (request_type == "Route"sv) {
-
-                ProcessRouteRequest(handler, stat_request, answers_array);
+            const auto [it, inserted] = group_by_origin.emplace(request.at("from").AsString(), groups.size());
+            if (inserted) {
+                groups.emplace_back();
+            }
+            groups[it->second].push_back(i);
+        }
 
+        json::Array answer_buffer;
+        std::vector<std::string_view> stops_to;
+        for (const std::vector<size_t>& group : groups) {
+            stops_to.clear();
+            for (const size_t i : group) {
+                stops_to.push_back(stat_requests[i].AsDict().at("to").AsString());
             }
-            else {
-                throw std::logic_error("bad stat request");
+            handler.PrepareRoutesFrom(stat_requests[group.front()].AsDict().at("from").AsString(), stops_to);
+            for (const size_t i : group) {
+                ProcessStatRequest(handler, stat_requests[i], answer_buffer);
+                answers_array[i] = std::move(answer_buffer.back());
+                answer_buffer.clear();
             }
+            handler.ClearPreparedRoutes();
+        }
+    }
+
+    void JsonReader::ProcessStatRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array) {
+        std::string_view request_type = stat_request.AsDict().at("type").AsString();
+        profiler::Scope scope("stat_request"sv, request_type);
+        if (request_type == "Bus"sv) {
+
+            ProcessBusStatRequest(handler, stat_request, answers_array);
+
+        }
+        else if (request_type == "Stop"sv) {
+
+            ProcessStopInfoRequest(handler, stat_request, answers_array);
+
+        }
+        else if (request_type == "Map"sv) {
+
+            ProcessMapRequest(handler, stat_request, answers_array);
+
+        }
+        else if (request_type == "Route"sv) {
+
+            ProcessRouteRequest(handler, stat_request, answers_array);
+
+        }
+        else if (request_type == "Isochrone"sv) {
+
+            ProcessIsochroneRequest(handler, stat_request, answers_array);
+
         }
+        else if (request_type == "ParetoRoute"sv) {
 
-        json::Document document{ answers_array };
-        return document;
+            ProcessParetoRouteRequest(handler, stat_request, answers_array);
+
+        }
+        else if (request_type == "ScheduledRoute"sv) {
+
+            ProcessScheduledRouteRequest(handler, stat_request, answers_array);
+
+        }
+        else if (request_type == "RouteTime"sv) {
+
+            ProcessRouteTimeRequest(handler, stat_request, answers_array);
+
+        }
+        else {
+            throw std::logic_error("bad stat request");
+        }
     }
 
     void JsonReader::ProcessBusStatRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array) {
@@ -165,8 +355,9 @@ namespace json_reader {
 
     void JsonReader::ProcessMapRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array) {
         int id = stat_request.AsDict().at("id").AsInt();
-        std::string map_as_string = std::move(handler.RenderMap());
-        answers_array.push_back(std::move(ConvertMapToJsonDict(id, map_as_string)));
+        const auto zoom = stat_request.AsDict().find("zoom");
+        const double zoom_value = zoom == stat_request.AsDict().end() ? 1.0 : zoom->second.AsDouble();
+        answers_array.push_back(ConvertMapToJsonDict(id, handler.RenderMap(zoom_value)));
     }
 
     json::Node JsonReader::ConvertBusStatToJsonDict(int id, std::optional<BusInfo> bus_stat) {
@@ -198,17 +389,15 @@ namespace json_reader {
 
     json::Node JsonReader::ConvertStopInfoToJsonDict(int id, std::optional<StopInfo> stop_info) {
         if (stop_info.has_value()) {
-            auto info = stop_info.value();
+            const StopBusesRange& bus_range = stop_info->buses_;
             json::Array buses;
-            for (const auto bus : info.buses_) {
-                buses.push_back(std::move(std::string(bus)));
+            buses.reserve(std::distance(bus_range.begin(), bus_range.end()));
+            for (BusPtr bus : bus_range) {
+                buses.emplace_back(std::string(bus->name_));
             }
-            json::Node answer{
-                json::Builder{}.StartDict()
-                    .Key("request_id").Value(id)
-                    .Key("buses").Value(buses)
-                .EndDict().Build()
-            };
+            json::Dict answer;
+            answer.emplace("request_id", id);
+            answer.emplace("buses", std::move(buses));
             return answer;
         }
         else {
@@ -223,12 +412,10 @@ namespace json_reader {
     }
 
     json::Node JsonReader::ConvertMapToJsonDict(int id, std::string map_as_string) {
-        json::Node answer{
-                json::Builder{}.StartDict()
-                    .Key("request_id").Value(id)
-                    .Key("map").Value(std::move(map_as_string))
-                .EndDict().Build()
-        };
+        // словарь собирается напрямую: json::Builder копирует значения, а карта велика
+        json::Dict answer;
+        answer.emplace("request_id", id);
+        answer.emplace("map", std::move(map_as_string));
         return answer;
     }
 
@@ -239,6 +426,56 @@ namespace json_reader {
         const json::Node& json_settings = document.GetRoot().AsDict().at("routing_settings").AsDict();
         settings.bus_wait_time = json_settings.AsDict().at("bus_wait_time").AsInt();
         settings.bus_velocity = json_settings.AsDict().at("bus_velocity").AsInt() * 100.0 / 6.0;
+        if (const auto it = json_settings.AsDict().find("router_algorithm"); it != json_settings.AsDict().end()) {
+            const std::string& algorithm = it->second.AsString();
+            if (algorithm == "all_pairs"sv) {
+                settings.algorithm = catalogue::RouterAlgorithm::ALL_PAIRS;
+            }
+            else if (algorithm == "dijkstra"sv) {
+                settings.algorithm = catalogue::RouterAlgorithm::DIJKSTRA;
+            }
+            else if (algorithm == "astar"sv) {
+                settings.algorithm = catalogue::RouterAlgorithm::A_STAR;
+            }
+            else if (algorithm == "alt"sv) {
+                settings.algorithm = catalogue::RouterAlgorithm::ALT;
+            }
+            else {
+                throw std::logic_error("bad router_algorithm");
+            }
+        }
+        if (const auto it = json_settings.AsDict().find("landmarks"); it != json_settings.AsDict().end()) {
+            if (it->second.AsInt() <= 0) {
+                throw std::logic_error("bad landmarks");
+            }
+            settings.landmark_count = static_cast<size_t>(it->second.AsInt());
+        }
+        if (const auto it = json_settings.AsDict().find("hub_labels"); it != json_settings.AsDict().end()) {
+            settings.hub_labels = it->second.AsBool();
+        }
+        return settings;
+    }
+
+    std::optional<catalogue::RoutingSettings> JsonReader::ReadRoutingSettingsOverride(const json::Document& document,
+        const catalogue::RoutingSettings& base_settings) const {
+        const json::Dict& root = document.GetRoot().AsDict();
+        const auto json_settings = root.find("routing_settings");
+        if (json_settings == root.end()) {
+            return std::nullopt;
+        }
+        catalogue::RoutingSettings settings = base_settings;
+        if (const auto it = json_settings->second.AsDict().find("bus_wait_time"); it != json_settings->second.AsDict().end()) {
+            settings.bus_wait_time = it->second.AsDouble();
+        }
+        if (const auto it = json_settings->second.AsDict().find("bus_velocity"); it != json_settings->second.AsDict().end()) {
+            settings.bus_velocity = it->second.AsDouble() * 100.0 / 6.0;
+        }
+        if (settings.bus_wait_time < 0.0 || settings.bus_velocity <= 0.0) {
+            throw std::logic_error("bad routing_settings");
+        }
+        if (settings.bus_wait_time == base_settings.bus_wait_time && settings.bus_velocity == base_settings.bus_velocity) {
+            return std::nullopt;
+        }
         return settings;
     }
 
@@ -246,47 +483,157 @@ namespace json_reader {
         int id = stat_request.AsDict().at("id").AsInt();
         std::string stop_from = stat_request.AsDict().at("from").AsString();
         std::string stop_to = stat_request.AsDict().at("to").AsString();
-        std::optional<graph::Router<BusRouteWeight>::RouteInfo> route_info = handler.GetRouteInfo(stop_from, stop_to);
-        answers_array.push_back(std::move(ConvertRouteInfoToJsonDict(id, route_info, handler)));
+        std::optional<BusRouteWeight> route_weight = handler.BuildRoute(stop_from, stop_to, route_edges_);
+        answers_array.push_back(std::move(ConvertRouteInfoToJsonDict(id, route_weight, route_edges_, handler)));
     }
 
-    json::Node JsonReader::ConvertRouteInfoToJsonDict(int id,
-        std::optional<graph::Router<BusRouteWeight>::RouteInfo> route_info,
-        RequestHandler& handler) {
+    void JsonReader::ProcessParetoRouteRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array) {
+        const json::Dict& request = stat_request.AsDict();
+        const auto max_boardings = request.find("max_boardings");
+        const bool is_found = handler.BuildParetoRoutes(request.at("from").AsString(), request.at("to").AsString(),
+            max_boardings == request.end() ? std::numeric_limits<int>::max() : max_boardings->second.AsInt(), pareto_routes_);
+
+        json::Dict answer;
+        answer.emplace("request_id", request.at("id").AsInt());
+        if (!is_found || pareto_routes_.journeys.empty()) {
+            answer.emplace("error_message", "not found");
+            answers_array.push_back(std::move(answer));
+            return;
+        }
+        json::Array routes;
+        routes.reserve(pareto_routes_.journeys.size());
+        for (const catalogue::ParetoJourney& journey : pareto_routes_.journeys) {
+            json::Dict route;
+            route.emplace("total_time", journey.time);
+            route.emplace("boardings", journey.boardings);
+            route.emplace("items", ConvertRouteItemsToJson(pareto_routes_.edges.begin() + journey.edges_begin,
+                pareto_routes_.edges.begin() + journey.edges_end, handler));
+            routes.push_back(std::move(route));
+        }
+        answer.emplace("routes", std::move(routes));
+        answers_array.push_back(std::move(answer));
+    }
+
+    void JsonReader::ProcessScheduledRouteRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array) {
+        const json::Dict& request = stat_request.AsDict();
+        const double departure_time = request.at("departure_time").AsDouble();
+        const std::optional<double> arrival_time = handler.BuildScheduledRoute(
+            request.at("from").AsString(), request.at("to").AsString(), departure_time, scheduled_legs_);
+
+        json::Dict answer;
+        answer.emplace("request_id", request.at("id").AsInt());
+        if (!arrival_time) {
+            answer.emplace("error_message", "not found");
+            answers_array.push_back(std::move(answer));
+            return;
+        }
+        answer.emplace("departure_time", departure_time);
+        answer.emplace("arrival_time", *arrival_time);
+        answer.emplace("total_time", *arrival_time - departure_time);
+
+        json::Array items;
+        items.reserve(2 * scheduled_legs_.size());
+        double time = departure_time;
+        for (const catalogue::ScheduledLeg& leg : scheduled_legs_) {
+            if (leg.departure > time) {
+                json::Dict wait;
+                wait.emplace("type", "Wait");
+                wait.emplace("stop_name", std::string(leg.from->name_));
+                wait.emplace("time", leg.departure - time);
+                items.push_back(std::move(wait));
+            }
+            json::Dict ride;
+            ride.emplace("type", "Bus");
+            ride.emplace("bus", std::string(leg.bus->name_));
+            ride.emplace("span_count", leg.span_count);
+            ride.emplace("time", leg.arrival - leg.departure);
+            ride.emplace("departure_time", leg.departure);
+            ride.emplace("arrival_time", leg.arrival);
+            items.push_back(std::move(ride));
+            time = leg.arrival;
+        }
+        answer.emplace("items", std::move(items));
+        answers_array.push_back(std::move(answer));
+    }
+
+    void JsonReader::ProcessRouteTimeRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array) {
+        const json::Dict& request = stat_request.AsDict();
+        const std::optional<double> total_time = handler.GetRouteTime(request.at("from").AsString(), request.at("to").AsString());
+
+        json::Dict answer;
+        answer.emplace("request_id", request.at("id").AsInt());
+        if (total_time) {
+            answer.emplace("total_time", *total_time);
+        }
+        else {
+            answer.emplace("error_message", "not found");
+        }
+        answers_array.push_back(std::move(answer));
+    }
+
+    void JsonReader::ProcessIsochroneRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array) {
+        int id = stat_request.AsDict().at("id").AsInt();
+        const std::string& stop_from = stat_request.AsDict().at("from").AsString();
+        double max_time = stat_request.AsDict().at("max_time").AsDouble();
+
+        json::Array stops;
+        bool is_found = handler.VisitIsochrone(stop_from, max_time, [&stops](StopPtr stop, double time) {
+            json::Dict item{};
+            item.emplace("stop_name", std::string(stop->name_));
+            item.emplace("time", time);
+            stops.push_back(std::move(item));
+            });
+
         json::Node answer = json::Builder{}
             .StartDict()
             .Key("request_id").Value(id)
             .EndDict()
             .Build();
+        if (is_found) {
+            answer.AsDict().emplace("stops", std::move(stops));
+        }
+        else {
+            answer.AsDict().emplace("error_message", "not found");
+        }
+        answers_array.push_back(std::move(answer));
+    }
 
-        if (route_info.has_value()) {
-            answer.AsDict().emplace("total_time", route_info->weight.time);
-            answer.AsDict().emplace("items", json::Array{});
-            json::Array& items = answer.AsDict().at("items").AsArray();
-            for (const graph::EdgeId edge_id : route_info->edges) {
-                json::Dict item{};
-                const graph::Edge<BusRouteWeight>& edge = handler.GetEdgeByIndex(edge_id);
-
-                double time = edge.weight.time;
-                item.emplace("time", time);
-
-                if (auto bus = handler.GetBusByEdgeIndex(edge_id)) {
-                    item.emplace("type", "Bus");
-                    std::string bus_name = bus->name_;
-                    item.emplace("bus", bus_name);
-                    item.emplace("span_count", edge.weight.span);
-
-                }
-                else {
-                    item.emplace("type", "Wait");
-                    item.emplace(
-                        "stop_name",
-                        handler.GetStopByVertexIndex(edge.from)->name_
-                    );
-                }
-                items.push_back(std::move(item));
+    json::Array JsonReader::ConvertRouteItemsToJson(std::vector<graph::EdgeId>::const_iterator begin,
+        std::vector<graph::EdgeId>::const_iterator end, RequestHandler& handler) const {
+        json::Array items;
+        items.reserve(std::distance(begin, end));
+        for (auto it = begin; it != end; ++it) {
+            const catalogue::EdgeInfo& edge_info = handler.GetEdgeInfo(*it);
+            json::Dict item{};
+            item.emplace("time", edge_info.time);
+
+            if (edge_info.is_wait) {
+                item.emplace("type", "Wait");
+                item.emplace("stop_name", std::string(edge_info.stop_name));
             }
+            else {
+                item.emplace("type", "Bus");
+                item.emplace("bus", std::string(edge_info.bus_name));
+                item.emplace("span_count", edge_info.span_count);
+            }
+            items.push_back(std::move(item));
+        }
+        return items;
+    }
 
+    json::Node JsonReader::ConvertRouteInfoToJsonDict(int id,
+        std::optional<BusRouteWeight> route_weight,
+        const std::vector<graph::EdgeId>& route_edges,
+        RequestHandler& handler) {
+        json::Node answer = json::Builder{}
+            .StartDict()
+            .Key("request_id").Value(id)
+            .EndDict()
+            .Build();
+
+        if (route_weight.has_value()) {
+            answer.AsDict().emplace("total_time", route_weight->time);
+            answer.AsDict().emplace("items", ConvertRouteItemsToJson(route_edges.begin(), route_edges.end(), handler));
         }
         else {
             answer.AsDict().emplace("error_message", "not found");
@@ -295,38 +642,47 @@ namespace json_reader {
     }
 
     void JsonReader::Fill(catalogue::TransportCatalogue& catalogue, catalogue::TransportRouter& router) {
-        for (const auto& [name, coordinates, _] : add_stop_requests_) {
-            catalogue.AddStop(name, coordinates);
-        }
-        for (const auto& [name_from, _, distances] : add_stop_requests_) {
-            StopPtr stop_from = catalogue.FindStop(name_from);
-            for (const auto& [name_to, distance] : distances) {
-                StopPtr stop_to = catalogue.FindStop(name_to);
-                catalogue.SetDistance({ stop_from, stop_to }, distance);
-            }
-            router.AddStopVertex(stop_from);
+        {
+            profiler::Scope scope("JsonReader::Fill catalogue"sv);
+            catalogue.AddBulk(add_stop_requests_, add_bus_requests_);
+        }
+
+        profiler::Scope scope("JsonReader::Fill graph build"sv);
+        for (const auto& add_stop_request : add_stop_requests_) {
+            router.AddStopVertex(catalogue.FindStop(add_stop_request.name));
         }
 
         router.AddBusWaitEdges();
 
-        for (const auto& [name, stops, type] : add_bus_requests_) {
-            BusType bus_type;
-            if (type) {
-                bus_type = BusType::CYCLED;
-            }
-            else {
-                bus_type = BusType::ORDINARY;
-            }
-            catalogue.AddBus(name, stops, bus_type);
-            router.AddBusEdges(name);
+        for (const auto& add_bus_request : add_bus_requests_) {
+            router.AddBusEdges(add_bus_request.name);
+        }
+    }
+
+    void JsonReader::FillTimetable(const catalogue::TransportCatalogue& catalogue, const catalogue::RoutingSettings& settings,
+        catalogue::Timetable& timetable) const {
+        profiler::Scope scope("JsonReader::FillTimetable"sv);
+        for (const catalogue::BusTripsDescription& bus_trips : bus_trips_requests_) {
+            timetable.AddBusTrips(catalogue.FindBus(bus_trips.bus_name), bus_trips.departures, settings.bus_velocity);
         }
+        timetable.SortConnections();
     }
 
     Serialize::SerializeSettings JsonReader::ReadSerializeSettings(const json::Document& document) const {
         Serialize::SerializeSettings settings;
         assert(document.GetRoot().IsDict());
         assert(document.GetRoot().AsDict().count("serialization_settings") != 0);
-        settings.file = document.GetRoot().AsDict().at("serialization_settings").AsDict().at("file").AsString();
+        const json::Dict& json_settings = document.GetRoot().AsDict().at("serialization_settings").AsDict();
+        settings.file = json_settings.at("file").AsString();
+        if (const auto it = json_settings.find("compression"); it != json_settings.end()) {
+            const std::string& compression = it->second.AsString();
+            if (compression == "zlib"sv) {
+                settings.codec = Serialize::Codec::ZLIB;
+            }
+            else if (compression != "none"sv) {
+                throw std::logic_error("bad compression");
+            }
+        }
         return settings;
     }
 }
@@ -10,6 +10,8 @@
 #include <iostream>
 #include <tuple>
 #include <iomanip>
+#include <limits>
+#include <optional>
 #include <cassert>
 #include <stdexcept>
 #include <sstream>
@@ -19,22 +21,16 @@
 #include "json_builder.h"
 #include "request_handler.h"
 #include "transport_router.h"
+#include "timetable.h"
 #include "serialization.h"
+#include "profiler.h"
 
 
 namespace json_reader {
 
-    struct AddStopRequest {
-        std::string name;
-        geo::Coordinates cordinates;
-        std::unordered_map<std::string, int> distances;
-    };
-
-    struct AddBusRequest {
-        std::string name;
-        std::vector<std::string> stops;
-        bool is_roundtrip;
-    };
+    // Имена в запросах ссылаются на строки документа JsonReader
+    using AddStopRequest = catalogue::StopDescription;
+    using AddBusRequest = catalogue::BusDescription;
 
     struct StatRequest {
         int id = 0;
@@ -45,10 +41,35 @@ namespace json_reader {
     class JsonReader {
     public:
         JsonReader(json::Document document);
+        // запросы base_requests ссылаются на document_, копия указывала бы на чужой документ
+        JsonReader(const JsonReader&) = delete;
+        JsonReader& operator=(const JsonReader&) = delete;
 
-        void ReadBaseRequests(json::Document document);
+        // запросы ссылаются на строки document, он должен пережить вызов Fill
+        void ReadBaseRequests(const json::Document& document);
         json::Document ProcessStatRequests(RequestHandler& handler);
+
+        // Части базы, нужные для ответа на stat_requests
+        struct StatRequestsNeeds {
+            // граф маршрутов: Route, ParetoRoute и Isochrone
+            bool route_graph = false;
+            // таблица graph::Router: Route
+            bool router = false;
+            // настройки и данные карты: Map
+            bool map = false;
+            // расписание: ScheduledRoute
+            bool timetable = false;
+            // метки хабов: RouteTime
+            bool hub_labels = false;
+        };
+        // Просматривает типы запросов stat_requests, не выполняя их
+        StatRequestsNeeds ScanStatRequests() const;
+        // Обрабатывает один запрос stat_requests и добавляет ответ в answers_array
+        void ProcessStatRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array);
         void Fill(catalogue::TransportCatalogue& catalogue, catalogue::TransportRouter& router);
+        // Строит расписание по ключам departures запросов Bus, вызывается после Fill
+        void FillTimetable(const catalogue::TransportCatalogue& catalogue, const catalogue::RoutingSettings& settings,
+            catalogue::Timetable& timetable) const;
 
         // ---- rendering ----
         renderer::RenderSettings ReadRenderSettingsFromJSON(const json::Document& document) const;
@@ -57,12 +78,17 @@ namespace json_reader {
         // ---- routing ----
         catalogue::RoutingSettings ReadRoutingSettings(const json::Document& document) const;
         void SetRoutingSettings(catalogue::RoutingSettings settings, catalogue::TransportCatalogue& catalogue) const;
+        // Необязательные bus_wait_time и bus_velocity в routing_settings запросов process_requests
+        // поверх настроек базы; nullopt, если метрика не меняется
+        std::optional<catalogue::RoutingSettings> ReadRoutingSettingsOverride(const json::Document& document,
+            const catalogue::RoutingSettings& base_settings) const;
 
         // ---- serialization ----
         Serialize::SerializeSettings ReadSerializeSettings(const json::Document& document) const;
     private:
-        std::deque<AddStopRequest> add_stop_requests_;
-        std::deque<AddBusRequest> add_bus_requests_;
+        std::vector<AddStopRequest> add_stop_requests_;
+        std::vector<AddBusRequest> add_bus_requests_;
+        std::vector<catalogue::BusTripsDescription> bus_trips_requests_;
 
         void AddStopBaseRequest(const json::Node& request);
         void AddBusBaseRequest(const json::Node& request);
@@ -72,15 +98,32 @@ namespace json_reader {
         json::Node ConvertBusStatToJsonDict(int id, std::optional<BusInfo> bus_stat);
         json::Node ConvertStopInfoToJsonDict(int id, std::optional<StopInfo> bus_stat);
         json::Node ConvertMapToJsonDict(int id, std::string map_as_string);
+        // Элементы Wait и Bus ответа на запрос маршрута
+        json::Array ConvertRouteItemsToJson(std::vector<graph::EdgeId>::const_iterator begin,
+            std::vector<graph::EdgeId>::const_iterator end, RequestHandler& handler) const;
         json::Node ConvertRouteInfoToJsonDict(int id,
-            std::optional<graph::Router<BusRouteWeight>::RouteInfo> route_info,
+            std::optional<BusRouteWeight> route_weight,
+            const std::vector<graph::EdgeId>& route_edges,
             RequestHandler& handler);
 
         void ProcessBusStatRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array);
         void ProcessStopInfoRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array);
         void ProcessMapRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array);
         void ProcessRouteRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array);
+        void ProcessParetoRouteRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array);
+        void ProcessScheduledRouteRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array);
+        void ProcessRouteTimeRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array);
+        void ProcessIsochroneRequest(RequestHandler& handler, const json::Node& stat_request, json::Array& answers_array);
+        // Отвечает на Route-запросы i с same_request[i] == i, по одному поиску на остановку отправления.
+        // Ответ на запрос i записывается в answers_array[i]
+        void ProcessRouteRequestsByOrigin(RequestHandler& handler, const json::Array& stat_requests,
+            const std::vector<size_t>& same_request, json::Array& answers_array);
         json::Document document_;
+        // рёбра последнего построенного маршрута, ёмкость переиспользуется между запросами
+        std::vector<graph::EdgeId> route_edges_;
+        // участки последнего маршрута по расписанию
+        std::vector<catalogue::ScheduledLeg> scheduled_legs_;
+        catalogue::ParetoRoutes pareto_routes_;
     };
 
 } // namespace json_reader
\ No newline at end of file
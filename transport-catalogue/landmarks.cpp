@@ -0,0 +1,181 @@
+#define _USE_MATH_DEFINES
+
+#include "landmarks.h"
+#include "parallel.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace catalogue {
+
+    Landmarks Landmarks::Build(const TransportRouter& transport_router, size_t count) {
+        Landmarks result;
+        const graph::DirectedWeightedGraph<BusRouteWeight>& route_graph = transport_router.GetRouteGraph<BusRouteWeight>();
+        const std::deque<StopPtr>& vertex_index_to_stop = transport_router.GetVertexIndexToStop();
+        const size_t stop_count = route_graph.GetVertexCount() / 2;
+        if (stop_count == 0 || count == 0) {
+            return result;
+        }
+
+        geo::Coordinates center;
+        for (size_t stop = 0; stop < stop_count; ++stop) {
+            center.lat += vertex_index_to_stop[2 * stop]->cordinates_.lat / stop_count;
+            center.lng += vertex_index_to_stop[2 * stop]->cordinates_.lng / stop_count;
+        }
+        std::vector<double> sector_distance(count, -1.0);
+        std::vector<uint32_t> sector_stop(count, 0);
+        for (size_t stop = 0; stop < stop_count; ++stop) {
+            const geo::Coordinates coordinates = vertex_index_to_stop[2 * stop]->cordinates_;
+            const double dlat = coordinates.lat - center.lat;
+            const double dlng = coordinates.lng - center.lng;
+            const size_t sector = std::min(count - 1, static_cast<size_t>((std::atan2(dlat, dlng) + M_PI) / (2 * M_PI) * count));
+            const double distance = dlat * dlat + dlng * dlng;
+            if (distance > sector_distance[sector]) {
+                sector_distance[sector] = distance;
+                sector_stop[sector] = static_cast<uint32_t>(stop);
+            }
+        }
+        for (size_t sector = 0; sector < count; ++sector) {
+            if (sector_distance[sector] >= 0.0) {
+                result.landmark_stops_.push_back(sector_stop[sector]);
+            }
+        }
+        const size_t landmark_count = result.landmark_stops_.size();
+
+        graph::DirectedWeightedGraph<BusRouteWeight> reversed_graph(route_graph.GetVertexCount());
+        for (const graph::Edge<BusRouteWeight>& edge : route_graph.GetEdges()) {
+            reversed_graph.AddEdge({ edge.to, edge.from, edge.weight });
+        }
+
+        // [поиск][остановка]: поиски 0 .. landmark_count - 1 - от ориентиров, остальные - к ним
+        std::vector<std::vector<double>> times(2 * landmark_count);
+        parallel::ForChunks(times.size(), 1, [&](size_t begin, size_t end) {
+            const graph::Router<BusRouteWeight> forward_router(route_graph, {});
+            const graph::Router<BusRouteWeight> backward_router(reversed_graph, {});
+            graph::Router<BusRouteWeight>::ShortestPathTree tree;
+            for (size_t search = begin; search < end; ++search) {
+                const graph::Router<BusRouteWeight>& router = search < landmark_count ? forward_router : backward_router;
+                router.BuildShortestPathTree(2 * result.landmark_stops_[search % landmark_count], {}, tree);
+                std::vector<double>& row = times[search];
+                row.assign(stop_count, std::numeric_limits<double>::infinity());
+                for (size_t stop = 0; stop < stop_count; ++stop) {
+                    if (tree.routes[2 * stop]) {
+                        row[stop] = tree.routes[2 * stop]->weight.time;
+                    }
+                }
+            }
+            });
+
+        // шаг квантования подбирается так, чтобы наибольшее время поместилось в uint16
+        double max_time = 0.0;
+        for (const std::vector<double>& row : times) {
+            for (const double time : row) {
+                if (std::isfinite(time)) {
+                    max_time = std::max(max_time, time);
+                }
+            }
+        }
+        result.time_quantum_ = max_time > 0.0 ? max_time / (UNREACHABLE - 1) : 1.0;
+
+        auto quantize = [&result](double time) {
+            if (!std::isfinite(time)) {
+                return UNREACHABLE;
+            }
+            return static_cast<uint16_t>(std::min<double>(UNREACHABLE - 1, std::floor(time / result.time_quantum_)));
+        };
+        result.from_landmarks_.resize(stop_count * landmark_count);
+        result.to_landmarks_.resize(stop_count * landmark_count);
+        for (size_t stop = 0; stop < stop_count; ++stop) {
+            for (size_t landmark = 0; landmark < landmark_count; ++landmark) {
+                result.from_landmarks_[stop * landmark_count + landmark] = quantize(times[landmark][stop]);
+                result.to_landmarks_[stop * landmark_count + landmark] = quantize(times[landmark_count + landmark][stop]);
+            }
+        }
+        return result;
+    }
+
+    size_t Landmarks::GetLandmarkCount() const {
+        return landmark_stops_.size();
+    }
+
+    size_t Landmarks::GetStopCount() const {
+        return landmark_stops_.empty() ? 0 : from_landmarks_.size() / landmark_stops_.size();
+    }
+
+    double Landmarks::GetTimeQuantum() const {
+        return time_quantum_;
+    }
+
+    const std::vector<uint32_t>& Landmarks::GetLandmarkStops() const {
+        return landmark_stops_;
+    }
+
+    const std::vector<uint16_t>& Landmarks::GetFromLandmarks() const {
+        return from_landmarks_;
+    }
+
+    const std::vector<uint16_t>& Landmarks::GetToLandmarks() const {
+        return to_landmarks_;
+    }
+
+    memory_stats::Report Landmarks::GetMemoryStats() const {
+        return {
+            memory_stats::Collect("landmark_stops_", landmark_stops_),
+            memory_stats::Collect("from_landmarks_", from_landmarks_),
+            memory_stats::Collect("to_landmarks_", to_landmarks_)
+        };
+    }
+
+    void Landmarks::Set(double time_quantum, std::vector<uint32_t>&& landmark_stops,
+        std::vector<uint16_t>&& from_landmarks, std::vector<uint16_t>&& to_landmarks) {
+        time_quantum_ = time_quantum;
+        landmark_stops_ = std::move(landmark_stops);
+        from_landmarks_ = std::move(from_landmarks);
+        to_landmarks_ = std::move(to_landmarks);
+    }
+
+    LandmarkLowerBound::LandmarkLowerBound(const Landmarks& landmarks, double bus_wait_time)
+        : landmarks_(landmarks)
+        , wait_time_(bus_wait_time) {
+    }
+
+    void LandmarkLowerBound::SetTarget(graph::VertexId to) {
+        const size_t landmark_count = landmarks_.GetLandmarkCount();
+        target_stop_ = to / 2;
+        const auto from_begin = landmarks_.GetFromLandmarks().begin() + target_stop_ * landmark_count;
+        const auto to_begin = landmarks_.GetToLandmarks().begin() + target_stop_ * landmark_count;
+        target_from_landmarks_.assign(from_begin, from_begin + landmark_count);
+        target_to_landmarks_.assign(to_begin, to_begin + landmark_count);
+    }
+
+    BusRouteWeight LandmarkLowerBound::operator()(graph::VertexId vertex) const {
+        const size_t stop = vertex / 2;
+        if (stop == target_stop_) {
+            return {};
+        }
+        const size_t landmark_count = landmarks_.GetLandmarkCount();
+        const uint16_t* from_landmarks = landmarks_.GetFromLandmarks().data() + stop * landmark_count;
+        const uint16_t* to_landmarks = landmarks_.GetToLandmarks().data() + stop * landmark_count;
+
+        // хранимое значение q означает время из [q, q + 1) шагов, отсюда вычитаемая единица
+        int quanta = 0;
+        for (size_t landmark = 0; landmark < landmark_count; ++landmark) {
+            if (target_from_landmarks_[landmark] != Landmarks::UNREACHABLE && from_landmarks[landmark] != Landmarks::UNREACHABLE) {
+                quanta = std::max(quanta, target_from_landmarks_[landmark] - from_landmarks[landmark] - 1);
+            }
+            if (to_landmarks[landmark] != Landmarks::UNREACHABLE && target_to_landmarks_[landmark] != Landmarks::UNREACHABLE) {
+                quanta = std::max(quanta, to_landmarks[landmark] - target_to_landmarks_[landmark] - 1);
+            }
+        }
+        const double time = quanta * landmarks_.GetTimeQuantum();
+        // времена ориентиров посчитаны для вершин прибытия; с вершины прибытия выходит
+        // только ребро ожидания, поэтому путь из вершины посадки короче ровно на ожидание
+        if (vertex % 2 == 0) {
+            return { std::max(time, wait_time_), 0 };
+        }
+        return { std::max(0.0, time - wait_time_), 0 };
+    }
+
+} // namespace catalogue
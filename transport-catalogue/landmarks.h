@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "domain.h"
+#include "graph.h"
+#include "memory_stats.h"
+#include "transport_router.h"
+
+namespace catalogue {
+
+    // Ориентиры для A* (ALT): времена пути от каждого ориентира до каждой остановки и обратно.
+    // Времена квантуются в uint16 с шагом time_quantum минут с округлением вниз,
+    // память линейна по числу остановок и ориентиров
+    class Landmarks {
+    public:
+        // время недостижимой остановки
+        static constexpr uint16_t UNREACHABLE = UINT16_MAX;
+
+        Landmarks() = default;
+
+        // Выбирает до count ориентиров планарным способом: плоскость вокруг центра остановок
+        // делится на count секторов, в каждом берётся самая удалённая от центра остановка.
+        // Поиски от ориентиров по графу и по обращённому графу выполняются параллельно
+        static Landmarks Build(const TransportRouter& transport_router, size_t count);
+
+        size_t GetLandmarkCount() const;
+        size_t GetStopCount() const;
+        double GetTimeQuantum() const;
+        // номера остановок в графе (вершина прибытия / 2)
+        const std::vector<uint32_t>& GetLandmarkStops() const;
+        // [остановка * число ориентиров + ориентир] - время от ориентира до остановки
+        const std::vector<uint16_t>& GetFromLandmarks() const;
+        // [остановка * число ориентиров + ориентир] - время от остановки до ориентира
+        const std::vector<uint16_t>& GetToLandmarks() const;
+
+        memory_stats::Report GetMemoryStats() const;
+
+        // serialization
+        void Set(double time_quantum, std::vector<uint32_t>&& landmark_stops,
+            std::vector<uint16_t>&& from_landmarks, std::vector<uint16_t>&& to_landmarks);
+
+    private:
+        double time_quantum_ = 1.0;
+        std::vector<uint32_t> landmark_stops_;
+        std::vector<uint16_t> from_landmarks_;
+        std::vector<uint16_t> to_landmarks_;
+    };
+
+    // Нижняя оценка времени пути до вершины прибытия цели по неравенству треугольника:
+    // d(v, t) >= d(L, t) - d(L, v) и d(v, t) >= d(v, L) - d(t, L) для каждого ориентира L.
+    // Из-за квантования оценка допустима, но не обязательно согласована
+    class LandmarkLowerBound {
+    public:
+        LandmarkLowerBound(const Landmarks& landmarks, double bus_wait_time);
+
+        void SetTarget(graph::VertexId to);
+        BusRouteWeight operator()(graph::VertexId vertex) const;
+
+    private:
+        const Landmarks& landmarks_;
+        double wait_time_ = 0.0;
+        graph::VertexId target_stop_ = 0;
+        // времена цели, чтобы не искать их при каждой оценке
+        std::vector<uint16_t> target_from_landmarks_;
+        std::vector<uint16_t> target_to_landmarks_;
+    };
+
+} // namespace catalogue
@@ -0,0 +1,253 @@
+#include "json.h"
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "router.h"
+#include "serialization.h"
+#include "synthetic_city.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <spawn.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+extern char** environ;
+
+using namespace std::literals;
+
+namespace {
+
+    struct LoadOptions {
+        synthetic::CityParams city;
+        std::optional<size_t> bus_count;
+        synthetic::StatRequestsParams requests;
+        std::filesystem::path binary;
+        std::filesystem::path work_dir = std::filesystem::temp_directory_path() / "transport_catalogue_load";
+        std::filesystem::path report;
+    };
+
+    struct ProcessResult {
+        double wall_ms = 0.0;
+        long peak_rss_kb = 0;
+    };
+
+    // Запускает binary mode с перенаправлением stdin и stdout в файлы
+    // и возвращает время работы и пиковый объём резидентной памяти процесса
+    ProcessResult RunProcess(const std::filesystem::path& binary, const std::string& mode,
+        const std::filesystem::path& input, const std::filesystem::path& output) {
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, 0, input.c_str(), O_RDONLY, 0);
+        posix_spawn_file_actions_addopen(&actions, 1, output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        const std::string binary_string = binary.string();
+        std::vector<char*> argv{ const_cast<char*>(binary_string.c_str()), const_cast<char*>(mode.c_str()), nullptr };
+
+        const auto start = std::chrono::steady_clock::now();
+        pid_t pid = 0;
+        const int spawn_error = posix_spawn(&pid, binary_string.c_str(), &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        if (spawn_error != 0) {
+            throw std::runtime_error("Can't start "s + binary_string);
+        }
+
+        int status = 0;
+        rusage usage{};
+        wait4(pid, &status, 0, &usage);
+        const auto finish = std::chrono::steady_clock::now();
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            throw std::runtime_error(binary_string + " "s + mode + " failed"s);
+        }
+
+        return { std::chrono::duration<double, std::milli>(finish - start).count(), usage.ru_maxrss };
+    }
+
+    // Повторяет в этом процессе конвейер process_requests и замеряет
+    // время обработки каждого запроса отдельно
+    std::map<std::string, std::vector<double>> MeasureLatencies(const json::Document& requests_doc) {
+        json_reader::JsonReader reader(requests_doc);
+
+        Serialize::Deserializer deserializer(reader.ReadSerializeSettings(requests_doc));
+        catalogue::TransportCatalogue cat = deserializer.GetTransportCatalogue();
+        catalogue::TransportRouter transport_router = deserializer.GetTransportRouter(cat);
+
+        renderer::MapRenderer renderer(deserializer.GetRenderSettings(), cat.GetBusesSorted());
+        graph::Router<BusRouteWeight> router = deserializer.GetRouter(transport_router.GetRouteGraph<BusRouteWeight>());
+        catalogue::Timetable timetable = deserializer.GetTimetable(cat);
+        catalogue::Landmarks landmarks = deserializer.GetLandmarks();
+        catalogue::HubLabels hub_labels = deserializer.GetHubLabels(cat);
+        RequestHandler handler(cat, renderer, router, transport_router, timetable, landmarks, hub_labels);
+
+        std::map<std::string, std::vector<double>> latencies;
+        json::Array answers;
+        for (const json::Node& request : requests_doc.GetRoot().AsDict().at("stat_requests").AsArray()) {
+            const auto start = std::chrono::steady_clock::now();
+            reader.ProcessStatRequest(handler, request, answers);
+            const auto finish = std::chrono::steady_clock::now();
+            latencies[request.AsDict().at("type").AsString()].push_back(
+                std::chrono::duration<double, std::micro>(finish - start).count());
+        }
+        return latencies;
+    }
+
+    double Percentile(const std::vector<double>& sorted_values, double percent) {
+        const size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * sorted_values.size()));
+        return sorted_values[std::clamp<size_t>(rank, 1, sorted_values.size()) - 1];
+    }
+
+    json::Node MakeLatencyReport(std::map<std::string, std::vector<double>> latencies) {
+        json::Dict report;
+        for (auto& [type, values] : latencies) {
+            std::sort(values.begin(), values.end());
+            json::Dict stats;
+            stats.emplace("count", static_cast<int>(values.size()));
+            stats.emplace("p50", Percentile(values, 50));
+            stats.emplace("p90", Percentile(values, 90));
+            stats.emplace("p99", Percentile(values, 99));
+            stats.emplace("max", values.back());
+            report.emplace(type, std::move(stats));
+        }
+        return report;
+    }
+
+    json::Node MakeConfigReport(const LoadOptions& options) {
+        const synthetic::RequestMix& mix = options.requests.mix;
+        json::Dict config;
+        config.emplace("stops", static_cast<int>(options.city.stop_count));
+        config.emplace("buses", static_cast<int>(options.city.bus_count));
+        config.emplace("route_length", static_cast<int>(options.city.route_length));
+        config.emplace("roundtrip_ratio", options.city.roundtrip_ratio);
+        config.emplace("distance_density", options.city.distance_density);
+        config.emplace("requests", static_cast<int>(options.requests.request_count));
+        config.emplace("zipf_exponent", options.requests.zipf_exponent);
+        config.emplace("mix", json::Dict{ { "Bus", mix.bus }, { "Stop", mix.stop }, { "Route", mix.route }, { "Map", mix.map } });
+        return config;
+    }
+
+    void WriteDocument(const json::Document& doc, const std::filesystem::path& path) {
+        std::ofstream out(path);
+        json::Print(doc, out);
+    }
+
+    synthetic::RequestMix ParseMix(std::string_view text) {
+        synthetic::RequestMix mix{ 0.0, 0.0, 0.0, 0.0 };
+        while (!text.empty()) {
+            const size_t comma = text.find(',');
+            const std::string_view item = text.substr(0, comma);
+            const size_t colon = item.find(':');
+            const std::string_view type = item.substr(0, colon);
+            const double weight = std::stod(std::string(item.substr(colon + 1)));
+            if (type == "bus"sv) {
+                mix.bus = weight;
+            } else if (type == "stop"sv) {
+                mix.stop = weight;
+            } else if (type == "route"sv) {
+                mix.route = weight;
+            } else if (type == "map"sv) {
+                mix.map = weight;
+            } else {
+                throw std::invalid_argument("Unknown request type in --mix: "s + std::string(type));
+            }
+            text.remove_prefix(comma == text.npos ? text.size() : comma + 1);
+        }
+        return mix;
+    }
+
+    void PrintUsage(std::ostream& stream = std::cerr) {
+        stream << "Usage: transport_catalogue_load [--stops=N] [--buses=N] [--route-length=N]\n"
+            "    [--roundtrip-ratio=X] [--distance-density=X] [--requests=N]\n"
+            "    [--mix=bus:40,stop:30,route:29,map:1] [--zipf=X] [--seed=N]\n"
+            "    [--binary=PATH] [--work-dir=PATH] [--report=PATH]\n"sv;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    options.city.stop_count = 300;
+    options.binary = std::filesystem::absolute(argv[0]).parent_path() / "transport_catalogue";
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        const size_t eq = arg.find('=');
+        const std::string_view key = arg.substr(0, eq);
+        const std::string value(eq == arg.npos ? ""sv : arg.substr(eq + 1));
+
+        if (key == "--stops"sv) {
+            options.city.stop_count = std::stoul(value);
+        } else if (key == "--buses"sv) {
+            options.bus_count = std::stoul(value);
+        } else if (key == "--route-length"sv) {
+            options.city.route_length = std::stoul(value);
+        } else if (key == "--roundtrip-ratio"sv) {
+            options.city.roundtrip_ratio = std::stod(value);
+        } else if (key == "--distance-density"sv) {
+            options.city.distance_density = std::stod(value);
+        } else if (key == "--requests"sv) {
+            options.requests.request_count = std::stoul(value);
+        } else if (key == "--mix"sv) {
+            options.requests.mix = ParseMix(value);
+        } else if (key == "--zipf"sv) {
+            options.requests.zipf_exponent = std::stod(value);
+        } else if (key == "--seed"sv) {
+            options.city.seed = static_cast<uint32_t>(std::stoul(value));
+            options.requests.seed = options.city.seed + 1;
+        } else if (key == "--binary"sv) {
+            options.binary = value;
+        } else if (key == "--work-dir"sv) {
+            options.work_dir = value;
+        } else if (key == "--report"sv) {
+            options.report = value;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    options.city.bus_count = options.bus_count.value_or(std::max<size_t>(1, options.city.stop_count / 10));
+
+    std::filesystem::create_directories(options.work_dir);
+    options.city.serialization_file = (options.work_dir / "base.db").string();
+    const std::filesystem::path base_input = options.work_dir / "make_base.json";
+    const std::filesystem::path requests_input = options.work_dir / "process_requests.json";
+
+    WriteDocument(synthetic::GenerateBase(options.city), base_input);
+    const json::Document requests_doc = synthetic::GenerateStatRequests(options.city, options.requests);
+    WriteDocument(requests_doc, requests_input);
+
+    const ProcessResult make_base = RunProcess(options.binary, "make_base"s, base_input, options.work_dir / "make_base.out");
+    const ProcessResult process = RunProcess(options.binary, "process_requests"s, requests_input, options.work_dir / "process_requests.out");
+
+    const double requests_count = static_cast<double>(options.requests.request_count);
+    json::Dict report;
+    report.emplace("config", MakeConfigReport(options));
+    report.emplace("make_base", json::Dict{
+        { "wall_ms", make_base.wall_ms },
+        { "peak_rss_kb", static_cast<int>(make_base.peak_rss_kb) } });
+    report.emplace("process_requests", json::Dict{
+        { "wall_ms", process.wall_ms },
+        { "requests_per_sec", requests_count / (process.wall_ms / 1000.0) },
+        { "peak_rss_kb", static_cast<int>(process.peak_rss_kb) } });
+    report.emplace("latency_us", MakeLatencyReport(MeasureLatencies(requests_doc)));
+
+    if (options.report.empty()) {
+        json::Print(json::Document{ std::move(report) }, std::cout);
+        std::cout << std::endl;
+    } else {
+        WriteDocument(json::Document{ std::move(report) }, options.report);
+    }
+}
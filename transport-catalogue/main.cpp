@@ -1,22 +1,205 @@
 #include "json.h"
+#include "json_binary.h"
 #include "request_handler.h"
 #include "json_reader.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+#include "timetable.h"
+#include "landmarks.h"
+#include "hub_labels.h"
 #include "serialization.h"
+#include "profiler.h"
 
 #include <transport_catalogue.pb.h>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <string_view>
 using namespace std::literals;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|process_requests|stats] [--profile=summary|trace:PATH]\n"
+        "    [--format=json|compact|cbor|msgpack]\n"sv;
+}
+
+// Формат ответов process_requests
+enum class OutputFormat {
+    JSON,
+    COMPACT_JSON,
+    CBOR,
+    MESSAGE_PACK
+};
+
+std::optional<OutputFormat> ParseOutputFormat(std::string_view value) {
+    if (value == "json"sv) {
+        return OutputFormat::JSON;
+    }
+    if (value == "compact"sv) {
+        return OutputFormat::COMPACT_JSON;
+    }
+    if (value == "cbor"sv) {
+        return OutputFormat::CBOR;
+    }
+    if (value == "msgpack"sv) {
+        return OutputFormat::MESSAGE_PACK;
+    }
+    return std::nullopt;
+}
+
+void PrintDocument(const json::Document& doc, OutputFormat format, std::ostream& output) {
+    switch (format) {
+    case OutputFormat::JSON:
+        json::Print(doc, output);
+        break;
+    case OutputFormat::COMPACT_JSON:
+        json::PrintCompact(doc, output);
+        break;
+    case OutputFormat::CBOR:
+        json::PrintCbor(doc, output);
+        break;
+    case OutputFormat::MESSAGE_PACK:
+        json::PrintMessagePack(doc, output);
+        break;
+    }
+}
+
+// Матрица всех пар строится только для RouterAlgorithm::ALL_PAIRS
+graph::Router<BusRouteWeight> MakeRouter(const catalogue::TransportRouter& transport_router) {
+    const auto& route_graph = transport_router.GetRouteGraph<BusRouteWeight>();
+    if (transport_router.GetRoutingSettings().algorithm == catalogue::RouterAlgorithm::ALL_PAIRS) {
+        return graph::Router<BusRouteWeight>(route_graph);
+    }
+    return graph::Router<BusRouteWeight>(route_graph, {});
+}
+
+// Времена ориентиров строятся только для RouterAlgorithm::ALT
+catalogue::Landmarks MakeLandmarks(const catalogue::TransportRouter& transport_router) {
+    const catalogue::RoutingSettings& settings = transport_router.GetRoutingSettings();
+    if (settings.algorithm != catalogue::RouterAlgorithm::ALT) {
+        return {};
+    }
+    return catalogue::Landmarks::Build(transport_router, settings.landmark_count);
+}
+
+// Метки хабов строятся, только если их просят routing_settings.hub_labels
+catalogue::HubLabels MakeHubLabels(const catalogue::TransportRouter& transport_router, const catalogue::TransportCatalogue& cat) {
+    if (!transport_router.GetRoutingSettings().hub_labels) {
+        return {};
+    }
+    return catalogue::HubLabels::Build(transport_router, cat);
+}
+
+// json::Node хранит int, а double печатается с шестью значащими цифрами,
+// поэтому большие значения выводятся приближённо
+json::Node CountToJson(size_t value) {
+    if (value <= static_cast<size_t>(std::numeric_limits<int>::max())) {
+        return static_cast<int>(value);
+    }
+    return static_cast<double>(value);
+}
+
+json::Node MemoryReportToJson(const memory_stats::Report& report) {
+    json::Array containers;
+    for (const memory_stats::ContainerStats& stats : report) {
+        json::Dict container{
+            { "name", stats.name },
+            { "elements", CountToJson(stats.elements) },
+            { "heap_bytes", CountToJson(stats.heap_bytes) }
+        };
+        if (stats.load_factor) {
+            container.emplace("load_factor", *stats.load_factor);
+        }
+        containers.push_back(std::move(container));
+    }
+    return json::Dict{
+        { "containers", std::move(containers) },
+        { "heap_bytes", CountToJson(memory_stats::TotalHeapBytes(report)) }
+    };
+}
+
+// Печатает оценку памяти по структурам базы. Если во входных данных есть base_requests,
+// база строится заново, как в make_base, иначе загружается из serialization_settings
+void PrintMemoryStats(std::istream& input, std::ostream& output) {
+    json::Document doc = json::Load(input);
+    json_reader::JsonReader reader(doc);
+
+    auto print = [&output](std::string_view source, const catalogue::TransportCatalogue& cat,
+        const catalogue::TransportRouter& transport_router, const graph::Router<BusRouteWeight>& router,
+        const renderer::MapRenderer& renderer, const catalogue::Timetable& timetable, const catalogue::Landmarks& landmarks,
+        const catalogue::HubLabels& hub_labels) {
+        const memory_stats::Report cat_report = cat.GetMemoryStats();
+        const memory_stats::Report transport_router_report = transport_router.GetMemoryStats();
+        const memory_stats::Report router_report = router.GetMemoryStats();
+        const memory_stats::Report renderer_report = renderer.GetMemoryStats();
+        const memory_stats::Report timetable_report = timetable.GetMemoryStats();
+        const memory_stats::Report landmarks_report = landmarks.GetMemoryStats();
+        const memory_stats::Report hub_labels_report = hub_labels.GetMemoryStats();
+        json::Dict result{
+            { "source", std::string(source) },
+            { "TransportCatalogue", MemoryReportToJson(cat_report) },
+            { "TransportRouter", MemoryReportToJson(transport_router_report) },
+            { "graph::Router", MemoryReportToJson(router_report) },
+            { "MapRenderer", MemoryReportToJson(renderer_report) },
+            { "Timetable", MemoryReportToJson(timetable_report) },
+            { "Landmarks", MemoryReportToJson(landmarks_report) },
+            { "HubLabels", MemoryReportToJson(hub_labels_report) },
+            { "heap_bytes", CountToJson(memory_stats::TotalHeapBytes(cat_report)
+                + memory_stats::TotalHeapBytes(transport_router_report)
+                + memory_stats::TotalHeapBytes(router_report)
+                + memory_stats::TotalHeapBytes(renderer_report)
+                + memory_stats::TotalHeapBytes(timetable_report)
+                + memory_stats::TotalHeapBytes(landmarks_report)
+                + memory_stats::TotalHeapBytes(hub_labels_report)) }
+        };
+        json::Print(json::Document{ std::move(result) }, output);
+    };
+
+    if (doc.GetRoot().AsDict().count("base_requests")) {
+        catalogue::TransportCatalogue cat;
+        catalogue::TransportRouter transport_router(reader.ReadRoutingSettings(doc), cat);
+        reader.Fill(cat, transport_router);
+        graph::Router<BusRouteWeight> router = MakeRouter(transport_router);
+        renderer::MapRenderer renderer(reader.GetRenderSettings(), cat.GetBusesSorted());
+        catalogue::Timetable timetable;
+        reader.FillTimetable(cat, transport_router.GetRoutingSettings(), timetable);
+        const catalogue::Landmarks landmarks = MakeLandmarks(transport_router);
+        const catalogue::HubLabels hub_labels = MakeHubLabels(transport_router, cat);
+        print("built"sv, cat, transport_router, router, renderer, timetable, landmarks, hub_labels);
+    }
+    else {
+        Serialize::Deserializer deserializer(reader.ReadSerializeSettings(doc));
+        catalogue::TransportCatalogue cat = deserializer.GetTransportCatalogue();
+        catalogue::TransportRouter transport_router = deserializer.GetTransportRouter(cat);
+        renderer::MapRenderer renderer(deserializer.GetRenderSettings(), cat.GetBusesSorted());
+        graph::Router<BusRouteWeight> router = deserializer.GetRouter(transport_router.GetRouteGraph<BusRouteWeight>());
+        const catalogue::Timetable timetable = deserializer.GetTimetable(cat);
+        const catalogue::Landmarks landmarks = deserializer.GetLandmarks();
+        const catalogue::HubLabels hub_labels = deserializer.GetHubLabels(cat);
+        print("deserialized"sv, cat, transport_router, router, renderer, timetable, landmarks, hub_labels);
+    }
 }
 
 int main(int argc, char* argv[]) {
-     if (argc != 2) {
+    if (argc < 2) {
+        PrintUsage();
+        return 1;
+    }
+
+    // профилирование включается переменной окружения TC_PROFILE или флагом --profile
+    profiler::EnableFromEnvironment();
+    OutputFormat output_format = OutputFormat::JSON;
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (arg.substr(0, 10) == "--profile="sv && profiler::EnableFromString(arg.substr(10))) {
+            continue;
+        }
+        if (arg.substr(0, 9) == "--format="sv) {
+            if (const auto format = ParseOutputFormat(arg.substr(9))) {
+                output_format = *format;
+                continue;
+            }
+        }
         PrintUsage();
         return 1;
     }
@@ -25,36 +208,108 @@ int main(int argc, char* argv[]) {
     
     if (mode == "make_base"sv) {
         {
-            json::Document doc = json::Load(std::cin);
-            json_reader::JsonReader reader(doc);
+            profiler::Scope total("make_base"sv);
+
+            json::Document doc = profiler::Measure("json::Load"sv, [] { return json::Load(std::cin); });
+            json_reader::JsonReader reader = profiler::Measure("JsonReader::ReadBaseRequests"sv, [&doc] { return json_reader::JsonReader(doc); });
 
             catalogue::TransportCatalogue cat;
             catalogue::TransportRouter transport_router(reader.ReadRoutingSettings(doc), cat);
             reader.Fill(cat, transport_router);
-            graph::Router<BusRouteWeight> router(transport_router.GetRouteGraph<BusRouteWeight>());
+            graph::Router<BusRouteWeight> router = profiler::Measure("graph::Router"sv, [&transport_router] {
+                return MakeRouter(transport_router);
+                });
+            const catalogue::Landmarks landmarks = profiler::Measure("catalogue::Landmarks"sv, [&transport_router] {
+                return MakeLandmarks(transport_router);
+                });
+            const catalogue::HubLabels hub_labels = profiler::Measure("catalogue::HubLabels"sv, [&transport_router, &cat] {
+                return MakeHubLabels(transport_router, cat);
+                });
+            catalogue::Timetable timetable;
+            reader.FillTimetable(cat, transport_router.GetRoutingSettings(), timetable);
 
-            Serialize::Serializer serializer(cat, transport_router, reader.GetRenderSettings(), reader.ReadSerializeSettings(doc), router);
-            serializer.Save();
+            Serialize::Serializer serializer = profiler::Measure("Serializer"sv, [&] {
+                return Serialize::Serializer(cat, transport_router, reader.GetRenderSettings(), reader.ReadSerializeSettings(doc),
+                    router, timetable, landmarks, hub_labels);
+                });
+            profiler::Measure("Serializer::Save"sv, [&serializer] { serializer.Save(); });
         }
 
     } else if (mode == "process_requests"sv) {
         {
-            json::Document doc = json::Load(std::cin);
+            profiler::Scope total("process_requests"sv);
+
+            json::Document doc = profiler::Measure("json::Load"sv, [] { return json::Load(std::cin); });
             json_reader::JsonReader reader(doc);
 
-            Serialize::Deserializer deserializer(reader.ReadSerializeSettings(doc));
-            catalogue::TransportCatalogue cat = deserializer.GetTransportCatalogue();
-            catalogue::TransportRouter transport_router = deserializer.GetTransportRouter(cat);
+            Serialize::Deserializer deserializer = profiler::Measure("Deserializer"sv, [&] {
+                return Serialize::Deserializer(reader.ReadSerializeSettings(doc));
+                });
+            catalogue::TransportCatalogue cat = profiler::Measure("Deserializer::GetTransportCatalogue"sv, [&deserializer] {
+                return deserializer.GetTransportCatalogue();
+                });
+
+            // части базы, которые не нужны ни одному запросу, не читаются и заменяются пустыми объектами
+            json_reader::JsonReader::StatRequestsNeeds needs = reader.ScanStatRequests();
+            // Новая метрика: веса графа пересчитываются по расстояниям рёбер, таблица graph::Router
+            // базы не читается (маршруты ищутся по запросу), ориентиры и метки хабов строятся заново
+            const std::optional<catalogue::RoutingSettings> metric = reader.ReadRoutingSettingsOverride(doc,
+                deserializer.GetRoutingSettings());
+            catalogue::HubLabels hub_labels = profiler::Measure("Deserializer::GetHubLabels"sv, [&] {
+                return needs.hub_labels && !metric ? deserializer.GetHubLabels(cat) : catalogue::HubLabels{};
+                });
+            const bool rebuild_hub_labels = needs.hub_labels && metric && metric->hub_labels;
+            // без меток в базе RouteTime ищет маршрут, как Route
+            if (needs.hub_labels && hub_labels.IsEmpty()) {
+                needs.route_graph = true;
+                needs.router = needs.router || !rebuild_hub_labels;
+            }
+            catalogue::TransportRouter transport_router = profiler::Measure("Deserializer::GetTransportRouter"sv, [&] {
+                return needs.route_graph ? deserializer.GetTransportRouter(cat) : catalogue::TransportRouter({}, cat);
+                });
+            if (metric && needs.route_graph) {
+                profiler::Measure("TransportRouter::Customize"sv, [&] {
+                    transport_router.Customize(metric->bus_wait_time, metric->bus_velocity);
+                    });
+            }
 
-            renderer::MapRenderer renderer(deserializer.GetRenderSettings(), cat.GetBusesSorted());
-            graph::Router<BusRouteWeight> router = deserializer.GetRouter(transport_router.GetRouteGraph<BusRouteWeight>());
-            RequestHandler handler(cat, renderer, router, transport_router);
-            json::Document result = reader.ProcessStatRequests(handler);
-            json::Print(result, std::cout);
+            renderer::MapRenderer renderer = profiler::Measure("Deserializer::GetRenderSettings"sv, [&] {
+                return needs.map ? renderer::MapRenderer(deserializer.GetRenderSettings(), cat.GetBusesSorted())
+                    : renderer::MapRenderer({}, {});
+                });
+            graph::Router<BusRouteWeight> router = profiler::Measure("Deserializer::GetRouter"sv, [&] {
+                const auto& route_graph = transport_router.GetRouteGraph<BusRouteWeight>();
+                // изохронам достаточно графа
+                return needs.router && !metric ? deserializer.GetRouter(route_graph) : graph::Router<BusRouteWeight>(route_graph, {});
+                });
+            catalogue::Timetable timetable = profiler::Measure("Deserializer::GetTimetable"sv, [&] {
+                return needs.timetable ? deserializer.GetTimetable(cat) : catalogue::Timetable{};
+                });
+            const catalogue::Landmarks landmarks = profiler::Measure("Deserializer::GetLandmarks"sv, [&] {
+                if (!needs.router) {
+                    return catalogue::Landmarks{};
+                }
+                return metric ? MakeLandmarks(transport_router) : deserializer.GetLandmarks();
+                });
+            if (rebuild_hub_labels) {
+                hub_labels = profiler::Measure("catalogue::HubLabels"sv, [&] {
+                    return catalogue::HubLabels::Build(transport_router, cat);
+                    });
+            }
+            RequestHandler handler(cat, renderer, router, transport_router, timetable, landmarks, hub_labels);
+            json::Document result = profiler::Measure("JsonReader::ProcessStatRequests"sv, [&] {
+                return reader.ProcessStatRequests(handler);
+                });
+            profiler::Measure("json::Print"sv, [&result, output_format] { PrintDocument(result, output_format, std::cout); });
         }
 
+    } else if (mode == "stats"sv) {
+        PrintMemoryStats(std::cin, std::cout);
+
     } else {
          PrintUsage();
          return 1;
     }
-}
\ No newline at end of file
+
+    profiler::Report();
+}
@@ -13,15 +13,100 @@ namespace renderer {
         };
     }
 
+    namespace {
+        double DistanceToSegment(svg::Point point, svg::Point begin, svg::Point end) {
+            const double dx = end.x - begin.x;
+            const double dy = end.y - begin.y;
+            const double length_sq = dx * dx + dy * dy;
+            double t = 0.0;
+            if (length_sq > 0.0) {
+                t = std::clamp(((point.x - begin.x) * dx + (point.y - begin.y) * dy) / length_sq, 0.0, 1.0);
+            }
+            return std::hypot(point.x - (begin.x + t * dx), point.y - (begin.y + t * dy));
+        }
+    } // namespace
+
+    std::vector<svg::Point> SimplifyPolyline(const std::vector<svg::Point>& points, double tolerance) {
+        if (points.size() < 3) {
+            return points;
+        }
+        std::vector<bool> keep(points.size(), false);
+        keep.front() = keep.back() = true;
+
+        // отрезки обрабатываются через стек, чтобы длинные маршруты не углубляли рекурсию
+        std::vector<std::pair<size_t, size_t>> segments{ { 0, points.size() - 1 } };
+        while (!segments.empty()) {
+            const auto [first, last] = segments.back();
+            segments.pop_back();
+
+            double max_distance = 0.0;
+            size_t farthest = first;
+            for (size_t i = first + 1; i < last; ++i) {
+                const double distance = DistanceToSegment(points[i], points[first], points[last]);
+                if (distance > max_distance) {
+                    max_distance = distance;
+                    farthest = i;
+                }
+            }
+            if (max_distance > tolerance) {
+                keep[farthest] = true;
+                segments.push_back({ first, farthest });
+                segments.push_back({ farthest, last });
+            }
+        }
+
+        std::vector<svg::Point> result;
+        for (size_t i = 0; i < points.size(); ++i) {
+            if (keep[i]) {
+                result.push_back(points[i]);
+            }
+        }
+        return result;
+    }
+
+    void MapRenderer::PrecomputeSimplifiedRoutes(const std::deque<BusPtr>& routes) {
+        if (render_settings_.simplify_tolerance <= 0.0) {
+            return;
+        }
+        zoom_levels_ = render_settings_.zoom_levels;
+        if (zoom_levels_.empty()) {
+            zoom_levels_.push_back(1.0);
+        }
+        std::sort(zoom_levels_.begin(), zoom_levels_.end());
+
+        int max_bus_id = -1;
+        for (BusPtr route : routes) {
+            max_bus_id = std::max(max_bus_id, route->id);
+        }
+
+        documents_.resize(zoom_levels_.size());
+        simplified_routes_.assign(zoom_levels_.size(), std::vector<std::vector<svg::Point>>(max_bus_id + 1));
+        std::vector<svg::Point> points;
+        for (BusPtr route : routes) {
+            points.clear();
+            for (StopPtr stop : route->stops_) {
+                points.push_back(sphere_proector_->operator()(stop->cordinates_));
+            }
+            for (size_t level = 0; level < zoom_levels_.size(); ++level) {
+                simplified_routes_[level][route->id] = SimplifyPolyline(points, render_settings_.simplify_tolerance / zoom_levels_[level]);
+            }
+        }
+    }
+
+    void MapRenderer::SetZoom(double zoom) {
+        const auto it = std::upper_bound(zoom_levels_.begin(), zoom_levels_.end(), zoom);
+        zoom_index_ = it == zoom_levels_.begin() ? 0 : static_cast<size_t>(std::prev(it) - zoom_levels_.begin());
+    }
+
     void MapRenderer::RenderRoutes(std::deque<BusPtr> buses) {
         size_t color_index = 0;
-        size_t colors_count = render_settings_.color_palette.size();
+        size_t colors_count = palette_.size();
 
         for (BusPtr bus : buses) {
-            auto color = render_settings_.color_palette[color_index % colors_count];
+            const svg::Color& color = palette_[color_index % colors_count];
             auto route = RenderRoute(bus, color);
             if (route.has_value()) {
-                document_.Add(route.value()
+                documents_[zoom_index_].Add(route.value()
                     .SetFillColor("none")
                     .SetStrokeWidth(render_settings_.line_width)
                     .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
@@ -32,7 +117,7 @@ namespace renderer {
 
         color_index = 0;
         for (BusPtr bus : buses) {
-            auto color = render_settings_.color_palette[color_index % colors_count];
+            const svg::Color& color = palette_[color_index % colors_count];
             if (bus->stops_.empty()) {
                 continue;
             }
@@ -41,7 +126,7 @@ namespace renderer {
         }
     }
 
-    std::optional<svg::Polyline> MapRenderer::RenderRoute(BusPtr bus, svg::Color color) {
+    std::optional<svg::Polyline> MapRenderer::RenderRoute(BusPtr bus, const svg::Color& color) {
         if (bus->stops_.empty()) {
             return std::nullopt;
         }
@@ -49,36 +134,53 @@ namespace renderer {
         svg::Polyline route;
         route.SetStrokeColor(color);
 
-        if (bus->bus_type_ == BusType::CYCLED) {
-            for (StopPtr stop : bus->stops_) {
-                route.AddPoint(sphere_proector_->operator()(stop->cordinates_));
-            }
+        if (bus->bus_type_ != BusType::CYCLED && bus->bus_type_ != BusType::ORDINARY) {
+            throw std::logic_error("wrong bus");
         }
-        else if (bus->bus_type_ == BusType::ORDINARY) {
-            for (StopPtr stop : bus->stops_) {
-                route.AddPoint(sphere_proector_->operator()(stop->cordinates_));
+
+        if (!simplified_routes_.empty()) {
+            // упрощается только прямое направление, обратное - его зеркало
+            const std::vector<svg::Point>& points = simplified_routes_[zoom_index_].at(bus->id);
+            for (const svg::Point& point : points) {
+                route.AddPoint(point);
             }
+            if (bus->bus_type_ == BusType::ORDINARY) {
+                for (auto point = std::next(points.rbegin()); point != points.rend(); ++point) {
+                    route.AddPoint(*point);
+                }
+            }
+            return route;
+        }
+
+        for (StopPtr stop : bus->stops_) {
+            route.AddPoint(sphere_proector_->operator()(stop->cordinates_));
+        }
+        if (bus->bus_type_ == BusType::ORDINARY) {
             for (auto stop = next(bus->stops_.rbegin());
                 stop != bus->stops_.rend();
                 ++stop)
             {
                 route.AddPoint(sphere_proector_->operator()((*stop)->cordinates_));
             }
-
-        }
-        else {
-            throw std::logic_error("wrong bus");
         }
 
         return route;
     }
 
     void MapRenderer::Render(const svg::RenderContext& context) const {
-        document_.Render(context.out);
+        documents_[zoom_index_].Render(context.out);
+    }
+
+    void MapRenderer::Render(svg::Buffer& out) const {
+        documents_[zoom_index_].Render(out);
+    }
+
+    bool MapRenderer::IsRendered() const {
+        return documents_[zoom_index_].GetObjectsCount() != 0;
     }
 
 
-    void MapRenderer::RenderRouteNames(BusPtr bus, svg::Color color) {
+    void MapRenderer::RenderRouteNames(BusPtr bus, const svg::Color& color) {
         if (bus->bus_type_ == BusType::CYCLED) {
             svg::Point first_stop_point = sphere_proector_->operator()(bus->stops_.front()->cordinates_);
             RenderBusLabel(bus->name_, color, first_stop_point);
@@ -98,27 +200,27 @@ namespace renderer {
         }
     }
 
-    void MapRenderer::RenderBusLabel(std::string_view text, svg::Color color, svg::Point point) {
+    void MapRenderer::RenderBusLabel(std::string_view text, const svg::Color& color, svg::Point point) {
         RenderBusLabelUnderlayer(text, color, point);
         RenderBusLabelToplayer(text, color, point);
     }
 
-    void MapRenderer::RenderBusLabelUnderlayer(std::string_view text, [[maybe_unused]] svg::Color color, svg::Point point) {
-        document_.Add(svg::Text()
+    void MapRenderer::RenderBusLabelUnderlayer(std::string_view text, [[maybe_unused]] const svg::Color& color, svg::Point point) {
+        documents_[zoom_index_].Add(svg::Text()
             .SetData(std::string(text))
             .SetPosition(point)
             .SetOffset(render_settings_.bus_label_offset)
             .SetFontSize(render_settings_.bus_label_font_size)
             .SetFontFamily("Verdana")
             .SetFontWeight("bold")
-            .SetFillColor(render_settings_.underlayer_color)
-            .SetStrokeColor(render_settings_.underlayer_color)
+            .SetFillColor(underlayer_color_)
+            .SetStrokeColor(underlayer_color_)
             .SetStrokeWidth(render_settings_.underlayer_width)
             .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
             .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND));
     }
-    void MapRenderer::RenderBusLabelToplayer(std::string_view text, svg::Color color, svg::Point point) {
-        document_.Add(svg::Text()
+    void MapRenderer::RenderBusLabelToplayer(std::string_view text, const svg::Color& color, svg::Point point) {
+        documents_[zoom_index_].Add(svg::Text()
             .SetData(std::string(text))
             .SetPosition(point)
             .SetOffset(render_settings_.bus_label_offset)
@@ -128,26 +230,17 @@ namespace renderer {
             .SetFillColor(color));
     }
 
-    void MapRenderer::RenderStops(const std::map<std::string_view, StopPtr>& stopname_to_stops,
-        const std::unordered_map<StopPtr, std::set<BusPtr>>& stops_to_buses) {
-
-        for (const auto& [stop_name, stop_ptr] : stopname_to_stops) {
-            if (stops_to_buses.count(stop_ptr) != 0
-                && !stops_to_buses.at(stop_ptr).empty()) {
-                RenderStopCircle(stop_ptr);
-            }
+    void MapRenderer::RenderStops(const std::vector<StopPtr>& stops) {
+        for (StopPtr stop_ptr : stops) {
+            RenderStopCircle(stop_ptr);
         }
-
-        for (const auto& [stop_name, stop_ptr] : stopname_to_stops) {
-            if (stops_to_buses.count(stop_ptr) != 0
-                && !stops_to_buses.at(stop_ptr).empty()) {
-                RenderStopLabel(stop_ptr);
-            }
+        for (StopPtr stop_ptr : stops) {
+            RenderStopLabel(stop_ptr);
         }
     }
     void MapRenderer::RenderStopCircle(StopPtr stop) {
         svg::Point center = sphere_proector_->operator()(stop->cordinates_);
-        document_.Add(svg::Circle()
+        documents_[zoom_index_].Add(svg::Circle()
             .SetCenter(center)
             .SetFillColor("white")
             .SetRadius(render_settings_.stop_radius));
@@ -161,20 +254,20 @@ namespace renderer {
     }
 
     void MapRenderer::RenderStopLabelUnderlayer(std::string_view stop_name, svg::Point point) {
-        document_.Add(svg::Text()
+        documents_[zoom_index_].Add(svg::Text()
             .SetData(std::string(stop_name))
             .SetPosition(point)
             .SetOffset(render_settings_.stop_label_offset)
             .SetFontSize(render_settings_.stop_label_font_size)
             .SetFontFamily("Verdana")
-            .SetFillColor(render_settings_.underlayer_color)
-            .SetStrokeColor(render_settings_.underlayer_color)
+            .SetFillColor(underlayer_color_)
+            .SetStrokeColor(underlayer_color_)
             .SetStrokeWidth(render_settings_.underlayer_width)
             .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
             .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND));
     }
     void MapRenderer::RenderStopLabelToplayer(std::string_view stop_name, svg::Point point) {
-        document_.Add(svg::Text()
+        documents_[zoom_index_].Add(svg::Text()
             .SetData(std::string(stop_name))
             .SetPosition(point)
             .SetOffset(render_settings_.stop_label_offset)
@@ -184,6 +277,36 @@ namespace renderer {
         );
     }
 
+    memory_stats::Report MapRenderer::GetMemoryStats() const {
+        memory_stats::Report report;
+
+        auto collect_colors = [&report](std::string_view name, const std::vector<svg::Color>& colors) {
+            memory_stats::ContainerStats& stats = report.emplace_back(memory_stats::Collect(name, colors));
+            for (const svg::Color& color : colors) {
+                if (const auto* str = std::get_if<std::string>(&color)) {
+                    stats.heap_bytes += memory_stats::HeapBytes(*str);
+                }
+            }
+        };
+        collect_colors("render_settings_.color_palette", render_settings_.color_palette);
+        collect_colors("palette_", palette_);
+
+        size_t objects_count = 0;
+        for (const svg::Document& document : documents_) {
+            objects_count += document.GetObjectsCount();
+        }
+        report.push_back({ "documents_", objects_count, objects_count * sizeof(std::unique_ptr<svg::Object>), std::nullopt });
+
+        memory_stats::ContainerStats& simplified = report.emplace_back(memory_stats::Collect("simplified_routes_", simplified_routes_));
+        for (const auto& level : simplified_routes_) {
+            simplified.heap_bytes += memory_stats::HeapBytes(level);
+            for (const std::vector<svg::Point>& points : level) {
+                simplified.heap_bytes += memory_stats::HeapBytes(points);
+            }
+        }
+        return report;
+    }
+
     const RenderSettings& MapRenderer::GetRenderSettings() const {
         return render_settings_;
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <optional>
@@ -16,6 +17,7 @@
 
 #include "svg.h"
 #include "domain.h"
+#include "memory_stats.h"
 
 namespace renderer {
 
@@ -37,6 +39,12 @@ namespace renderer {
         double underlayer_width = 0.0;
 
         std::vector<svg::Color> color_palette;
+
+        // Допуск упрощения ломаных маршрутов (Дуглас-Пекер) в пикселях, 0 - без упрощения
+        double simplify_tolerance = 0.0;
+        // Масштабы, для которых упрощённые маршруты строятся заранее.
+        // На масштабе z допуск в координатах карты равен simplify_tolerance / z
+        std::vector<double> zoom_levels;
     };
 
     inline const double EPSILON = 1e-6;
@@ -61,7 +69,13 @@ namespace renderer {
     class MapRenderer {
     public:
         explicit MapRenderer(RenderSettings&& render_settings, std::deque<BusPtr> routes)
-            : render_settings_(render_settings) {
+            : render_settings_(render_settings)
+            , underlayer_color_(svg::PreformatColor(render_settings_.underlayer_color)) {
+
+            palette_.reserve(render_settings_.color_palette.size());
+            for (const svg::Color& color : render_settings_.color_palette) {
+                palette_.push_back(svg::PreformatColor(color));
+            }
 
             std::unordered_set<geo::Coordinates, CoordinatesHasher> points;
             for (BusPtr route : routes) {
@@ -78,34 +92,62 @@ namespace renderer {
                 render_settings_.padding
                 );
 
+            PrecomputeSimplifiedRoutes(routes);
         }
 
-        std::optional<svg::Polyline> RenderRoute(BusPtr bus, svg::Color color);
+        std::optional<svg::Polyline> RenderRoute(BusPtr bus, const svg::Color& color);
 
         void RenderRoutes(std::deque<BusPtr> buses);
-        void RenderStops(const std::map<std::string_view, StopPtr>& stopname_to_stops,
-            const std::unordered_map<StopPtr, std::set<BusPtr>>& stops_to_buses);
+        // stops - остановки, через которые проходят автобусы, в порядке имён
+        void RenderStops(const std::vector<StopPtr>& stops);
         void Render(const svg::RenderContext& context) const;
+        void Render(svg::Buffer& out) const;
+        // true, если документ карты для выбранного масштаба уже построен
+        bool IsRendered() const;
+
+        // Выбирает наибольший из zoom_levels, не превосходящий zoom (или наименьший, если таких нет).
+        // Render* после этого работают с документом и упрощёнными маршрутами этого масштаба
+        void SetZoom(double zoom);
 
 
-        void RenderRouteNames(BusPtr bus, svg::Color color);
-        void RenderBusLabel(std::string_view text, svg::Color color, svg::Point point);
-        void RenderBusLabelToplayer(std::string_view text, svg::Color color, svg::Point point);
-        void RenderBusLabelUnderlayer(std::string_view text, [[maybe_unused]] svg::Color color, svg::Point point);
+        void RenderRouteNames(BusPtr bus, const svg::Color& color);
+        void RenderBusLabel(std::string_view text, const svg::Color& color, svg::Point point);
+        void RenderBusLabelToplayer(std::string_view text, const svg::Color& color, svg::Point point);
+        void RenderBusLabelUnderlayer(std::string_view text, [[maybe_unused]] const svg::Color& color, svg::Point point);
 
         void RenderStopCircle(StopPtr stop);
         void RenderStopLabel(StopPtr stop);
         void RenderStopLabelUnderlayer(std::string_view stop_name_, svg::Point point);
         void RenderStopLabelToplayer(std::string_view stop_name_, svg::Point point);
 
+        // Оценка занимаемой памяти. Сами svg-объекты документа не учитываются,
+        // только их количество и массив указателей на них
+        memory_stats::Report GetMemoryStats() const;
+
         // serialization
         const RenderSettings& GetRenderSettings() const;
     private:
         const RenderSettings render_settings_;
+        // цвета из настроек, заранее переведённые в строки
+        std::vector<svg::Color> palette_;
+        svg::Color underlayer_color_;
         std::unique_ptr<SphereProjector> sphere_proector_ = nullptr;
-        svg::Document document_;
+
+        // по возрастанию; пусто, если упрощение выключено
+        std::vector<double> zoom_levels_;
+        size_t zoom_index_ = 0;
+        // [уровень][id автобуса] - упрощённая ломаная в прямом направлении
+        std::vector<std::vector<std::vector<svg::Point>>> simplified_routes_;
+        // документ карты для каждого уровня
+        std::vector<svg::Document> documents_{ 1 };
+
+        void PrecomputeSimplifiedRoutes(const std::deque<BusPtr>& routes);
     };
 
+    // Упрощает ломаную алгоритмом Дугласа-Пекера: оставляет концы и точки,
+    // удалённые от аппроксимирующего отрезка больше чем на tolerance
+    std::vector<svg::Point> SimplifyPolyline(const std::vector<svg::Point>& points, double tolerance);
+
     template <typename PointInputIt>
     SphereProjector::SphereProjector(PointInputIt points_begin, PointInputIt points_end,
         double max_width, double max_height, double padding)
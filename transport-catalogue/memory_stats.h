@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Оценка объёма кучи, занятого контейнерами. Размеры служебных частей узлов
+// соответствуют libstdc++ и дают оценку, а не точный учёт аллокатора
+namespace memory_stats {
+
+    struct ContainerStats {
+        std::string name;
+        size_t elements = 0;
+        size_t heap_bytes = 0;
+        std::optional<double> load_factor;
+    };
+
+    using Report = std::vector<ContainerStats>;
+
+    // служебная часть узла красно-чёрного дерева: цвет и три указателя
+    inline constexpr size_t TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+    // узел хеш-таблицы: указатель на следующий узел и закешированный хеш
+    inline constexpr size_t HASH_NODE_OVERHEAD = 2 * sizeof(void*);
+    // размер блока std::deque в libstdc++
+    inline constexpr size_t DEQUE_BLOCK_BYTES = 512;
+
+    inline size_t HeapBytes(const std::string& str) {
+        // короткие строки хранятся внутри объекта
+        return str.capacity() > 15 ? str.capacity() + 1 : 0;
+    }
+
+    template <typename T>
+    size_t HeapBytes(const std::vector<T>& container) {
+        return container.capacity() * sizeof(T);
+    }
+
+    template <typename T>
+    size_t HeapBytes(const std::deque<T>& container) {
+        const size_t per_block = sizeof(T) < DEQUE_BLOCK_BYTES ? DEQUE_BLOCK_BYTES / sizeof(T) : 1;
+        const size_t blocks = container.size() / per_block + 1;
+        return blocks * std::max(DEQUE_BLOCK_BYTES, sizeof(T)) + (blocks + 2) * sizeof(T*);
+    }
+
+    template <typename Key, typename Value, typename Compare>
+    size_t HeapBytes(const std::map<Key, Value, Compare>& container) {
+        return container.size() * (sizeof(std::pair<const Key, Value>) + TREE_NODE_OVERHEAD);
+    }
+
+    template <typename Key, typename Compare>
+    size_t HeapBytes(const std::set<Key, Compare>& container) {
+        return container.size() * (sizeof(Key) + TREE_NODE_OVERHEAD);
+    }
+
+    template <typename Key, typename Value, typename Hash, typename Equal>
+    size_t HeapBytes(const std::unordered_map<Key, Value, Hash, Equal>& container) {
+        return container.size() * (sizeof(std::pair<const Key, Value>) + HASH_NODE_OVERHEAD)
+            + container.bucket_count() * sizeof(void*);
+    }
+
+    // Статистика контейнера без учёта памяти, на которую ссылаются его элементы
+    template <typename Container>
+    ContainerStats Collect(std::string_view name, const Container& container) {
+        return { std::string(name), container.size(), HeapBytes(container), std::nullopt };
+    }
+
+    template <typename Key, typename Value, typename Hash, typename Equal>
+    ContainerStats Collect(std::string_view name, const std::unordered_map<Key, Value, Hash, Equal>& container) {
+        return { std::string(name), container.size(), HeapBytes(container), container.load_factor() };
+    }
+
+    inline size_t TotalHeapBytes(const Report& report) {
+        size_t total = 0;
+        for (const ContainerStats& stats : report) {
+            total += stats.heap_bytes;
+        }
+        return total;
+    }
+
+} // namespace memory_stats
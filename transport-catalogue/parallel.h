@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <future>
+#include <thread>
+#include <vector>
+
+// Простое распараллеливание на std::async без общего пула потоков.
+// Исключение из любой части перебрасывается в вызывающий поток
+namespace parallel {
+
+    // Число потоков: переменная окружения TC_THREADS, иначе std::thread::hardware_concurrency()
+    inline size_t GetThreadCount() {
+        static const size_t thread_count = [] {
+            if (const char* value = std::getenv("TC_THREADS")) {
+                const long count = std::strtol(value, nullptr, 10);
+                if (count > 0) {
+                    return static_cast<size_t>(count);
+                }
+            }
+            return std::max<size_t>(1, std::thread::hardware_concurrency());
+        }();
+        return thread_count;
+    }
+
+    // Делит [0, count) на непрерывные части не короче min_chunk (кроме, возможно, последней)
+    // и вызывает func(begin, end) для каждой части в своём потоке, первую - в вызывающем
+    template <typename Func>
+    void ForChunks(size_t count, size_t min_chunk, Func func) {
+        if (count == 0) {
+            return;
+        }
+        const size_t max_chunks = (count + std::max<size_t>(1, min_chunk) - 1) / std::max<size_t>(1, min_chunk);
+        const size_t chunks = std::min(GetThreadCount(), max_chunks);
+        const size_t chunk_size = (count + chunks - 1) / chunks;
+
+        std::vector<std::future<void>> futures;
+        futures.reserve(chunks);
+        for (size_t begin = chunk_size; begin < count; begin += chunk_size) {
+            const size_t end = std::min(count, begin + chunk_size);
+            futures.push_back(std::async(std::launch::async, [&func, begin, end] { func(begin, end); }));
+        }
+        func(0, std::min(count, chunk_size));
+        for (std::future<void>& future : futures) {
+            future.get();
+        }
+    }
+
+    // Выполняет функции одновременно, если потоков больше одного, иначе по очереди
+    template <typename First, typename... Rest>
+    void Invoke(First first, Rest... rest) {
+        if (GetThreadCount() == 1) {
+            first();
+            (rest(), ...);
+            return;
+        }
+        std::vector<std::future<void>> futures;
+        futures.reserve(sizeof...(rest));
+        (futures.push_back(std::async(std::launch::async, rest)), ...);
+        first();
+        for (std::future<void>& future : futures) {
+            future.get();
+        }
+    }
+
+} // namespace parallel
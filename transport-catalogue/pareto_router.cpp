@@ -0,0 +1,90 @@
+#include "pareto_router.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace catalogue {
+
+    ParetoRouter::ParetoRouter(const graph::DirectedWeightedGraph<BusRouteWeight>& graph)
+        : graph_(graph) {
+    }
+
+    void ParetoRouter::FindRoutes(graph::VertexId from, graph::VertexId to, int max_boardings, ParetoRoutes& routes) {
+        routes.journeys.clear();
+        routes.edges.clear();
+        arena_.clear();
+
+        const size_t stop_count = graph_.GetVertexCount() / 2;
+        best_time_.assign(stop_count, std::numeric_limits<double>::infinity());
+        round_label_.assign(stop_count, NO_LABEL);
+        label_round_.assign(stop_count, -1);
+        marked_.clear();
+
+        const uint32_t stop_from = static_cast<uint32_t>(from / 2);
+        const uint32_t stop_to = static_cast<uint32_t>(to / 2);
+        arena_.push_back({});
+        best_time_[stop_from] = 0.0;
+        marked_.push_back({ stop_from, 0 });
+        if (stop_from == stop_to) {
+            AppendJourney(0, 0, routes);
+            return;
+        }
+
+        for (int round = 1; round <= max_boardings && !marked_.empty(); ++round) {
+            next_marked_.clear();
+            for (const Marked marked : marked_) {
+                const double time = arena_[marked.label].time;
+                // из вершины прибытия выходит только ребро ожидания
+                for (const graph::EdgeId wait_edge_id : graph_.GetIncidentEdges(2 * marked.stop)) {
+                    const graph::Edge<BusRouteWeight>& wait_edge = graph_.GetEdge(wait_edge_id);
+                    const double boarding_time = time + wait_edge.weight.time;
+                    for (const graph::EdgeId edge_id : graph_.GetIncidentEdges(wait_edge.to)) {
+                        const graph::Edge<BusRouteWeight>& edge = graph_.GetEdge(edge_id);
+                        const uint32_t stop = static_cast<uint32_t>(edge.to / 2);
+                        const double arrival = boarding_time + edge.weight.time;
+                        if (arrival >= best_time_[stop] || arrival >= best_time_[stop_to]) {
+                            continue;
+                        }
+                        best_time_[stop] = arrival;
+                        const Label label{ arrival, edge_id, marked.label };
+                        // в пределах раунда метка остановки заменяется на месте
+                        if (label_round_[stop] == round) {
+                            arena_[round_label_[stop]] = label;
+                            continue;
+                        }
+                        label_round_[stop] = round;
+                        round_label_[stop] = static_cast<uint32_t>(arena_.size());
+                        arena_.push_back(label);
+                        next_marked_.push_back({ stop, round_label_[stop] });
+                    }
+                }
+            }
+            if (label_round_[stop_to] == round) {
+                AppendJourney(round_label_[stop_to], round, routes);
+            }
+            std::swap(marked_, next_marked_);
+        }
+    }
+
+    void ParetoRouter::AppendJourney(uint32_t label, int boardings, ParetoRoutes& routes) const {
+        ParetoJourney& journey = routes.journeys.emplace_back();
+        journey.time = arena_[label].time;
+        journey.boardings = boardings;
+        journey.edges_begin = routes.edges.size();
+        for (; arena_[label].prev != NO_LABEL; label = arena_[label].prev) {
+            const graph::EdgeId edge_id = arena_[label].edge;
+            routes.edges.push_back(edge_id);
+            // ребро ожидания перед посадкой
+            const graph::VertexId boarding_vertex = graph_.GetEdge(edge_id).from;
+            for (const graph::EdgeId wait_edge_id : graph_.GetIncidentEdges(boarding_vertex - 1)) {
+                if (graph_.GetEdge(wait_edge_id).to == boarding_vertex) {
+                    routes.edges.push_back(wait_edge_id);
+                    break;
+                }
+            }
+        }
+        journey.edges_end = routes.edges.size();
+        std::reverse(routes.edges.begin() + journey.edges_begin, routes.edges.end());
+    }
+
+} // namespace catalogue
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "domain.h"
+#include "graph.h"
+
+namespace catalogue {
+
+    // Маршрут из множества Парето: за time минут с boardings посадками
+    struct ParetoJourney {
+        double time = 0.0;
+        int boardings = 0;
+        // рёбра маршрута - ParetoRoutes::edges[edges_begin, edges_end)
+        size_t edges_begin = 0;
+        size_t edges_end = 0;
+    };
+
+    // Буферы результата, переиспользуются между запросами
+    struct ParetoRoutes {
+        // по возрастанию числа посадок и убыванию времени
+        std::vector<ParetoJourney> journeys;
+        std::vector<graph::EdgeId> edges;
+    };
+
+    // Маршруты, оптимальные по паре (время, число посадок), на графе TransportRouter.
+    // Поиск идёт раундами, как RAPTOR: в раунде k к остановкам, улучшенным в раунде k - 1,
+    // добавляется ожидание и одна поездка автобусом. Остановка улучшается, только если
+    // новое время меньше лучшего за все раунды и лучшего времени до цели
+    class ParetoRouter {
+    public:
+        explicit ParetoRouter(const graph::DirectedWeightedGraph<BusRouteWeight>& graph);
+
+        // from и to - вершины прибытия остановок. Не больше max_boardings посадок
+        void FindRoutes(graph::VertexId from, graph::VertexId to, int max_boardings, ParetoRoutes& routes);
+
+    private:
+        static constexpr uint32_t NO_LABEL = UINT32_MAX;
+
+        // Прибытие на остановку; метки неизменяемы после раунда, в котором созданы
+        struct Label {
+            double time = 0.0;
+            // ребро поездки, которым приехали; для начальной метки не задано
+            graph::EdgeId edge = 0;
+            uint32_t prev = NO_LABEL;
+        };
+
+        // Остановка, улучшенная в прошлом раунде, и её метка
+        struct Marked {
+            uint32_t stop = 0;
+            uint32_t label = 0;
+        };
+
+        const graph::DirectedWeightedGraph<BusRouteWeight>& graph_;
+
+        // Все метки запроса подряд: память выделяется только при росте, между запросами сохраняется
+        std::vector<Label> arena_;
+        // лучшее время прибытия на остановку за все раунды
+        std::vector<double> best_time_;
+        // метка остановки в текущем раунде и номер этого раунда
+        std::vector<uint32_t> round_label_;
+        std::vector<int> label_round_;
+        std::vector<Marked> marked_;
+        std::vector<Marked> next_marked_;
+
+        void AppendJourney(uint32_t label, int boardings, ParetoRoutes& routes) const;
+    };
+
+} // namespace catalogue
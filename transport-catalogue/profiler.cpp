@@ -0,0 +1,224 @@
+#include "profiler.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "json.h"
+
+using namespace std::literals;
+
+namespace profiler {
+
+    namespace {
+
+        struct Event {
+            std::string name;
+            double start_us = 0.0;
+            double duration_us = 0.0;
+            uint64_t allocations = 0;
+            uint64_t allocated_bytes = 0;
+            int64_t rss_delta_kb = 0;
+        };
+
+        struct State {
+            Mode mode = Mode::OFF;
+            std::string trace_path;
+            std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+            std::vector<Event> events;
+        };
+
+        State& GetState() {
+            static State state;
+            return state;
+        }
+
+        // Счётчики читаются в operator new, поэтому не зависят от порядка инициализации
+        std::atomic<bool> is_enabled{ false };
+        std::atomic<uint64_t> allocations{ 0 };
+        std::atomic<uint64_t> allocated_bytes{ 0 };
+
+        int64_t GetRssKb() {
+#ifdef __linux__
+            std::ifstream statm("/proc/self/statm");
+            int64_t total_pages = 0, resident_pages = 0;
+            if (statm >> total_pages >> resident_pages) {
+                return resident_pages * (sysconf(_SC_PAGESIZE) / 1024);
+            }
+#endif
+            return 0;
+        }
+
+        void PrintSummary(const std::vector<Event>& events, std::ostream& out) {
+            struct Total {
+                size_t count = 0;
+                double duration_us = 0.0;
+                uint64_t allocations = 0;
+                uint64_t allocated_bytes = 0;
+                int64_t rss_delta_kb = 0;
+            };
+            std::vector<std::string> order;
+            std::map<std::string, Total> totals;
+            for (const Event& event : events) {
+                auto [it, inserted] = totals.emplace(event.name, Total{});
+                if (inserted) {
+                    order.push_back(event.name);
+                }
+                Total& total = it->second;
+                ++total.count;
+                total.duration_us += event.duration_us;
+                total.allocations += event.allocations;
+                total.allocated_bytes += event.allocated_bytes;
+                total.rss_delta_kb += event.rss_delta_kb;
+            }
+
+            out << std::left << std::setw(44) << "phase"sv << std::right << std::setw(8) << "count"sv
+                << std::setw(12) << "total ms"sv << std::setw(12) << "avg us"sv << std::setw(12) << "allocs"sv
+                << std::setw(12) << "alloc KB"sv << std::setw(12) << "RSS +KB"sv << '\n';
+            for (const std::string& name : order) {
+                const Total& total = totals.at(name);
+                out << std::left << std::setw(44) << name << std::right << std::setw(8) << total.count
+                    << std::fixed << std::setprecision(3) << std::setw(12) << total.duration_us / 1000.0
+                    << std::setprecision(1) << std::setw(12) << total.duration_us / total.count
+                    << std::setw(12) << total.allocations << std::setw(12) << total.allocated_bytes / 1024
+                    << std::setw(12) << total.rss_delta_kb << '\n';
+            }
+        }
+
+        void WriteTrace(const std::vector<Event>& events, const std::string& path) {
+            json::Array trace_events;
+            trace_events.reserve(events.size());
+            for (const Event& event : events) {
+                json::Dict args{
+                    { "allocations", static_cast<double>(event.allocations) },
+                    { "allocated_bytes", static_cast<double>(event.allocated_bytes) },
+                    { "rss_delta_kb", static_cast<double>(event.rss_delta_kb) }
+                };
+                trace_events.push_back(json::Dict{
+                    { "name", event.name },
+                    { "ph", "X"s },
+                    { "ts", event.start_us },
+                    { "dur", event.duration_us },
+                    { "pid", 1 },
+                    { "tid", 1 },
+                    { "args", std::move(args) }
+                    });
+            }
+            std::ofstream out(path);
+            json::Print(json::Document{ json::Dict{ { "traceEvents", std::move(trace_events) } } }, out);
+        }
+
+    } // namespace
+
+    void Enable(Mode mode, std::string trace_path) {
+        State& state = GetState();
+        state.mode = mode;
+        state.trace_path = std::move(trace_path);
+        is_enabled = mode != Mode::OFF;
+    }
+
+    bool EnableFromString(std::string_view value) {
+        if (value == "summary"sv) {
+            Enable(Mode::SUMMARY);
+        }
+        else if (value.substr(0, 6) == "trace:"sv && value.size() > 6) {
+            Enable(Mode::TRACE, std::string(value.substr(6)));
+        }
+        else if (value == "off"sv || value.empty()) {
+            Enable(Mode::OFF);
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+
+    void EnableFromEnvironment() {
+        if (const char* value = std::getenv("TC_PROFILE")) {
+            if (!EnableFromString(value)) {
+                std::cerr << "TC_PROFILE: expected summary or trace:PATH\n"sv;
+            }
+        }
+    }
+
+    bool IsEnabled() {
+        return is_enabled.load(std::memory_order_relaxed);
+    }
+
+    Scope::Scope(std::string_view name)
+        : is_active_(IsEnabled()) {
+        if (!is_active_) {
+            return;
+        }
+        name_ = std::string(name);
+        start_rss_kb_ = GetRssKb();
+        start_allocations_ = allocations.load(std::memory_order_relaxed);
+        start_allocated_bytes_ = allocated_bytes.load(std::memory_order_relaxed);
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    Scope::Scope(std::string_view category, std::string_view name)
+        : Scope(IsEnabled() ? std::string(category) + " "s + std::string(name) : std::string{}) {
+    }
+
+    Scope::~Scope() {
+        if (!is_active_) {
+            return;
+        }
+        const auto finish = std::chrono::steady_clock::now();
+        const uint64_t finish_allocations = allocations.load(std::memory_order_relaxed);
+        const uint64_t finish_allocated_bytes = allocated_bytes.load(std::memory_order_relaxed);
+
+        State& state = GetState();
+        state.events.push_back(Event{
+            std::move(name_),
+            std::chrono::duration<double, std::micro>(start_ - state.origin).count(),
+            std::chrono::duration<double, std::micro>(finish - start_).count(),
+            finish_allocations - start_allocations_,
+            finish_allocated_bytes - start_allocated_bytes_,
+            GetRssKb() - start_rss_kb_
+            });
+    }
+
+    void Report(std::ostream& out) {
+        State& state = GetState();
+        // сам отчёт не должен попадать в счётчики
+        is_enabled = false;
+        if (state.mode == Mode::SUMMARY) {
+            PrintSummary(state.events, out);
+        }
+        else if (state.mode == Mode::TRACE) {
+            WriteTrace(state.events, state.trace_path);
+        }
+    }
+
+} // namespace profiler
+
+// Глобальные операторы new/delete считают выделения памяти, пока профилирование включено
+
+void* operator new(std::size_t size) {
+    if (profiler::is_enabled.load(std::memory_order_relaxed)) {
+        profiler::allocations.fetch_add(1, std::memory_order_relaxed);
+        profiler::allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace profiler {
+
+    enum class Mode {
+        OFF,
+        // сводка по фазам в конце работы
+        SUMMARY,
+        // события в формате Chrome trace-event (chrome://tracing, Perfetto)
+        TRACE
+    };
+
+    // Включает профилирование. Для Mode::TRACE trace_path - файл для событий
+    void Enable(Mode mode, std::string trace_path = {});
+
+    // Разбирает значение вида "summary" или "trace:PATH".
+    // Возвращает false, если значение не распознано
+    bool EnableFromString(std::string_view value);
+
+    // Включает профилирование по переменной окружения TC_PROFILE
+    void EnableFromEnvironment();
+
+    bool IsEnabled();
+
+    // Замеряет время, число и объём выделений памяти и изменение RSS
+    // от создания до разрушения объекта. При выключенном профилировании ничего не делает
+    class Scope {
+    public:
+        explicit Scope(std::string_view name);
+        Scope(std::string_view category, std::string_view name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        bool is_active_ = false;
+        std::string name_;
+        std::chrono::steady_clock::time_point start_;
+        uint64_t start_allocations_ = 0;
+        uint64_t start_allocated_bytes_ = 0;
+        int64_t start_rss_kb_ = 0;
+    };
+
+    // Вызывает func() внутри Scope с именем name и возвращает её результат
+    template <typename Func>
+    auto Measure(std::string_view name, Func func) {
+        Scope scope(name);
+        return func();
+    }
+
+    // Печатает сводку в out (режим SUMMARY) или записывает файл трассировки (режим TRACE)
+    void Report(std::ostream& out = std::cerr);
+
+} // namespace profiler
@@ -18,42 +18,134 @@ std::optional<StopInfo> RequestHandler::GetStopInfo(const std::string_view& stop
     }
 }
 
-RequestHandler::RequestHandler(const TransportCatalogue& db, renderer::MapRenderer& renderer, graph::Router<BusRouteWeight>& router, catalogue::TransportRouter& t_router)
-    : db_(db), renderer_(renderer), router_(router), t_router_(t_router)
+RequestHandler::RequestHandler(const TransportCatalogue& db, renderer::MapRenderer& renderer, graph::Router<BusRouteWeight>& router, catalogue::TransportRouter& t_router,
+    const catalogue::Timetable& timetable,
+    const catalogue::Landmarks& landmarks,
+    const catalogue::HubLabels& hub_labels)
+    : db_(db), renderer_(renderer), router_(router), t_router_(t_router), hub_labels_(hub_labels), scanner_(timetable, db)
+    , pareto_router_(t_router.GetRouteGraph<BusRouteWeight>())
 {
+    const catalogue::RoutingSettings& settings = t_router.GetRoutingSettings();
+    if (router.IsOnDemand() && settings.algorithm == catalogue::RouterAlgorithm::A_STAR) {
+        lower_bound_.emplace(t_router, db);
+    }
+    // ориентиры должны быть построены для этого графа
+    if (router.IsOnDemand() && settings.algorithm == catalogue::RouterAlgorithm::ALT && landmarks.GetLandmarkCount() != 0
+        && landmarks.GetStopCount() == t_router.GetRouteGraph<BusRouteWeight>().GetVertexCount() / 2) {
+        landmark_lower_bound_.emplace(landmarks, settings.bus_wait_time);
+    }
 }
 
-std::string RequestHandler::RenderMap() {
-    std::deque<BusPtr> buses = db_.GetBusesSorted();
-    renderer_.RenderRoutes(buses);
+std::string RequestHandler::RenderMap(double zoom) {
+    renderer_.SetZoom(zoom);
+    // документ масштаба строится при первом запросе, следующие только выводят его
+    if (!renderer_.IsRendered()) {
+        renderer_.RenderRoutes(db_.GetBusesSorted());
+        renderer_.RenderStops(db_.GetStopsWithBusesSorted());
+    }
 
-    const auto stops_to_buses = db_.GetStopsToBuses();
-    const auto stopname_to_stops = db_.GetStopnameToStops();
-    renderer_.RenderStops(stopname_to_stops, stops_to_buses);
+    svg::Buffer out;
+    renderer_.Render(out);
+    return out.Release();
+}
 
-    std::ostringstream out;
-    renderer_.Render({out, 0, 0});
+std::optional<BusRouteWeight> RequestHandler::BuildRoute(std::string_view stop_from, std::string_view stop_to,
+    std::vector<graph::EdgeId>& edges) const {
+    const graph::VertexId from = t_router_.GetStopVertexIndex(stop_from);
+    const graph::VertexId to = t_router_.GetStopVertexIndex(stop_to);
+    if (has_route_tree_ && route_tree_.from == from) {
+        return router_.BuildRoute(route_tree_, to, edges);
+    }
+    return SearchRoute(from, to, edges);
+}
 
-    return out.str();
+std::optional<BusRouteWeight> RequestHandler::SearchRoute(graph::VertexId from, graph::VertexId to,
+    std::vector<graph::EdgeId>& edges) const {
+    if (lower_bound_) {
+        lower_bound_->SetTarget(to);
+        router_.BuildGoalDirectedTree(from, to, *lower_bound_, search_tree_);
+        return router_.BuildRoute(search_tree_, to, edges);
+    }
+    if (landmark_lower_bound_) {
+        landmark_lower_bound_->SetTarget(to);
+        router_.BuildGoalDirectedTree(from, to, *landmark_lower_bound_, search_tree_);
+        return router_.BuildRoute(search_tree_, to, edges);
+    }
+    if (router_.IsOnDemand()) {
+        search_targets_.assign(1, to);
+        router_.BuildShortestPathTree(from, search_targets_, search_tree_);
+        return router_.BuildRoute(search_tree_, to, edges);
+    }
+    return router_.BuildRoute(from, to, edges);
 }
 
-std::optional<graph::Router<BusRouteWeight>::RouteInfo> RequestHandler::GetRouteInfo(std::string_view stop_from, std::string_view stop_to) const {
-    std::optional<graph::Router<BusRouteWeight>::RouteInfo> route_info = router_.BuildRoute(
-        t_router_.GetStopVertexIndex(stop_from),
-        t_router_.GetStopVertexIndex(stop_to)
-    );
-    return route_info;
+bool RequestHandler::IsRouteSearchOnDemand() const {
+    return router_.IsOnDemand() && !lower_bound_ && !landmark_lower_bound_;
 }
 
-const graph::Edge<BusRouteWeight>& RequestHandler::GetEdgeByIndex(graph::EdgeId edge_id) const {
-    return t_router_.GetEdgeByIndex(edge_id);
+void RequestHandler::PrepareRoutesFrom(std::string_view stop_from, const std::vector<std::string_view>& stops_to) {
+    has_route_tree_ = false;
+    if (!db_.FindStop(stop_from)) {
+        return;
+    }
+    route_targets_.clear();
+    for (std::string_view stop_to : stops_to) {
+        if (db_.FindStop(stop_to)) {
+            route_targets_.push_back(t_router_.GetStopVertexIndex(stop_to));
+        }
+    }
+    if (route_targets_.empty()) {
+        return;
+    }
+    router_.BuildShortestPathTree(t_router_.GetStopVertexIndex(stop_from), route_targets_, route_tree_);
+    has_route_tree_ = true;
 }
 
-BusPtr RequestHandler::GetBusByEdgeIndex(graph::EdgeId edge_id) const {
-    return t_router_.GetBusByEdgeIndex(edge_id);
+void RequestHandler::ClearPreparedRoutes() {
+    has_route_tree_ = false;
 }
 
-StopPtr RequestHandler::GetStopByVertexIndex(graph::VertexId vertex_id) const {
-    return t_router_.GetStopByVertexIndex(vertex_id);
+bool RequestHandler::BuildParetoRoutes(std::string_view stop_from, std::string_view stop_to, int max_boardings,
+    catalogue::ParetoRoutes& routes) {
+    if (!db_.FindStop(stop_from) || !db_.FindStop(stop_to)) {
+        routes.journeys.clear();
+        routes.edges.clear();
+        return false;
+    }
+    pareto_router_.FindRoutes(t_router_.GetStopVertexIndex(stop_from), t_router_.GetStopVertexIndex(stop_to),
+        max_boardings, routes);
+    return true;
 }
 
+std::optional<double> RequestHandler::BuildScheduledRoute(std::string_view stop_from, std::string_view stop_to,
+    double departure_time, std::vector<catalogue::ScheduledLeg>& legs) {
+    const StopPtr from = db_.FindStop(stop_from);
+    const StopPtr to = db_.FindStop(stop_to);
+    if (!from || !to) {
+        legs.clear();
+        return std::nullopt;
+    }
+    return scanner_.FindEarliestArrival(from, to, departure_time, legs);
+}
+
+std::optional<double> RequestHandler::GetRouteTime(std::string_view stop_from, std::string_view stop_to) const {
+    const StopPtr from = db_.FindStop(stop_from);
+    const StopPtr to = db_.FindStop(stop_to);
+    if (!from || !to) {
+        return std::nullopt;
+    }
+    if (!hub_labels_.IsEmpty()) {
+        return hub_labels_.GetRouteTime(from->id, to->id);
+    }
+    // дерево PrepareRoutesFrom может не покрывать stop_to, поэтому поиск отдельный
+    const std::optional<BusRouteWeight> weight = SearchRoute(t_router_.GetStopVertexIndex(stop_from),
+        t_router_.GetStopVertexIndex(stop_to), route_time_edges_);
+    if (!weight) {
+        return std::nullopt;
+    }
+    return weight->time;
+}
+
+const catalogue::EdgeInfo& RequestHandler::GetEdgeInfo(graph::EdgeId edge_id) const {
+    return t_router_.GetEdgeInfo(edge_id);
+}
@@ -5,6 +5,10 @@
 
 #include "transport_catalogue.h"
 #include "transport_router.h"
+#include "timetable.h"
+#include "pareto_router.h"
+#include "landmarks.h"
+#include "hub_labels.h"
 #include "map_renderer.h"
 #include "svg.h"
 #include "router.h"
@@ -17,28 +21,99 @@ public:
     RequestHandler(const TransportCatalogue& db, 
     renderer::MapRenderer& renderer, 
     graph::Router<BusRouteWeight>& router,
-    catalogue::TransportRouter& t_router);
+    catalogue::TransportRouter& t_router,
+    const catalogue::Timetable& timetable,
+    const catalogue::Landmarks& landmarks,
+    const catalogue::HubLabels& hub_labels);
 
     std::optional<BusInfo> GetBusStat(const std::string_view& bus_name) const;
 
-    std::string RenderMap();
+    // zoom выбирает уровень детализации маршрутов, см. RenderSettings::zoom_levels
+    std::string RenderMap(double zoom = 1.0);
 
     std::optional<StopInfo> GetStopInfo(const std::string_view& bus_name) const;
 
-    std::optional<graph::Router<BusRouteWeight>::RouteInfo> GetRouteInfo(std::string_view stop_from, std::string_view stop_to) const;
+    // Записывает рёбра маршрута в edges (буфер переиспользуется между запросами)
+    // и возвращает его вес
+    std::optional<BusRouteWeight> BuildRoute(std::string_view stop_from, std::string_view stop_to,
+        std::vector<graph::EdgeId>& edges) const;
 
+    // true, если маршруты ищутся поиском Дейкстры по запросу и запросы выгодно группировать
+    // по остановке отправления
+    bool IsRouteSearchOnDemand() const;
 
-    const graph::Edge<BusRouteWeight>& GetEdgeByIndex(graph::EdgeId edge_id) const;
-    BusPtr GetBusByEdgeIndex(graph::EdgeId edge_id) const;
-    StopPtr GetStopByVertexIndex(graph::VertexId vertex_id) const;
+    // Строит одно дерево кратчайших путей из stop_from до всех stops_to.
+    // Следующие BuildRoute из stop_from восстанавливают маршруты по нему до вызова ClearPreparedRoutes.
+    // Неизвестные остановки пропускаются
+    void PrepareRoutesFrom(std::string_view stop_from, const std::vector<std::string_view>& stops_to);
+    // Дерево покрывает только stops_to, поэтому после группы запросов оно сбрасывается
+    void ClearPreparedRoutes();
+
+
+    // Маршруты из stop_from в stop_to, оптимальные по паре (время, число посадок),
+    // не больше max_boardings посадок. Возвращает false, если какой-то остановки нет
+    bool BuildParetoRoutes(std::string_view stop_from, std::string_view stop_to, int max_boardings,
+        catalogue::ParetoRoutes& routes);
+
+    // Маршрут по расписанию с самым ранним прибытием при отправлении из stop_from не раньше departure_time.
+    // Записывает участки в legs и возвращает время прибытия; nullopt, если остановки нет или доехать нельзя
+    std::optional<double> BuildScheduledRoute(std::string_view stop_from, std::string_view stop_to, double departure_time,
+        std::vector<catalogue::ScheduledLeg>& legs);
+
+    // Время маршрута без его рёбер: по меткам хабов, если они есть, иначе как BuildRoute.
+    // nullopt, если остановки нет или доехать нельзя
+    std::optional<double> GetRouteTime(std::string_view stop_from, std::string_view stop_to) const;
+
+    // Вызывает callback(stop, time) для каждой остановки, до которой можно добраться
+    // из stop_from не дольше чем за max_time минут, в порядке возрастания времени.
+    // Возвращает false, если остановки stop_from нет в справочнике
+    template <typename Callback>
+    bool VisitIsochrone(std::string_view stop_from, double max_time, Callback callback) const;
+
+    const catalogue::EdgeInfo& GetEdgeInfo(graph::EdgeId edge_id) const;
 
 private:
+    // Маршрут поиском по графу или по таблице graph::Router, без дерева PrepareRoutesFrom
+    std::optional<BusRouteWeight> SearchRoute(graph::VertexId from, graph::VertexId to,
+        std::vector<graph::EdgeId>& edges) const;
+
     const TransportCatalogue& db_;
     renderer::MapRenderer& renderer_;
 
     const graph::Router<BusRouteWeight>& router_;
     const catalogue::TransportRouter& t_router_;
-};
-
 
+    // дерево последнего PrepareRoutesFrom
+    graph::Router<BusRouteWeight>::ShortestPathTree route_tree_;
+    bool has_route_tree_ = false;
+    std::vector<graph::VertexId> route_targets_;
+    // только для RouterAlgorithm::A_STAR и RouterAlgorithm::ALT
+    mutable std::optional<catalogue::RouteTimeLowerBound> lower_bound_;
+    mutable std::optional<catalogue::LandmarkLowerBound> landmark_lower_bound_;
+    // дерево и цель поиска SearchRoute; буферы переиспользуются между запросами
+    mutable graph::Router<BusRouteWeight>::ShortestPathTree search_tree_;
+    mutable std::vector<graph::VertexId> search_targets_;
+
+    const catalogue::HubLabels& hub_labels_;
+    // рёбра маршрута GetRouteTime без меток хабов, не возвращаются
+    mutable std::vector<graph::EdgeId> route_time_edges_;
+
+    catalogue::ConnectionScanner scanner_;
+    catalogue::ParetoRouter pareto_router_;
+};
 
+template <typename Callback>
+bool RequestHandler::VisitIsochrone(std::string_view stop_from, double max_time, Callback callback) const {
+    if (!db_.FindStop(stop_from)) {
+        return false;
+    }
+    router_.VisitReachable(
+        t_router_.GetStopVertexIndex(stop_from),
+        BusRouteWeight{ max_time, 0 },
+        [this, &callback](graph::VertexId vertex_id, const BusRouteWeight& weight) {
+            if (t_router_.IsStopArrivalVertex(vertex_id)) {
+                callback(t_router_.GetStopByVertexIndex(vertex_id), weight.time);
+            }
+        });
+    return true;
+}
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <iterator>
 #include <optional>
+#include <queue>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
@@ -28,7 +29,28 @@ public:
 
     using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
 
+    // Кратчайшие пути из одной вершины: строка матрицы routes_internal_data_,
+    // найденная поиском Дейкстры
+    struct ShortestPathTree {
+        // элемент очереди поиска: ключ упорядочения (вес пути, у A* - вес плюс оценка),
+        // вершина и вес пути до неё на момент добавления
+        struct QueueItem {
+            Weight key;
+            VertexId vertex;
+            Weight weight;
+        };
+
+        VertexId from = 0;
+        std::vector<std::optional<RouteInternalData>> routes;
+
+        // рабочие буферы поиска; сбрасываются в начале каждого поиска, ёмкость сохраняется
+        std::vector<bool> settled;
+        std::vector<bool> is_target;
+        std::vector<QueueItem> queue;
+    };
+
     explicit Router(const Graph& graph);
+    // Пустая routes_internal_data - матрица не строится, маршруты ищутся по запросу
     explicit Router(const Graph& graph, RoutesInternalData&& routes_internal_data);
 
     struct RouteInfo {
@@ -38,7 +60,36 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    // Записывает рёбра маршрута в edges, переиспользуя его ёмкость,
+    // и возвращает вес маршрута. Если маршрута нет, edges остаётся пустым
+    std::optional<Weight> BuildRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const;
+
+    // Маршрут до to по дереву, построенному BuildShortestPathTree
+    std::optional<Weight> BuildRoute(const ShortestPathTree& tree, VertexId to, std::vector<EdgeId>& edges) const;
+
+    // Строит дерево кратчайших путей из from. Поиск останавливается, как только
+    // найдены пути до всех targets; пустой targets - до всех достижимых вершин.
+    // Буферы tree переиспользуются
+    void BuildShortestPathTree(VertexId from, const std::vector<VertexId>& targets, ShortestPathTree& tree) const;
+
+    // Поиск A* из from в to: вершины раскрываются в порядке веса пути плюс heuristic(vertex) -
+    // нижней оценки веса пути из vertex в to. Если оценка не согласована, вершина раскрывается
+    // повторно при улучшении её веса, и маршрут остаётся кратчайшим. Маршрут восстанавливает
+    // BuildRoute(tree, to, edges); буферы tree переиспользуются
+    template <typename Heuristic>
+    void BuildGoalDirectedTree(VertexId from, VertexId to, const Heuristic& heuristic, ShortestPathTree& tree) const;
+
+    // true, если матрица всех пар не построена
+    bool IsOnDemand() const;
+
+    // Обходит все вершины, достижимые из from с весом не больше budget,
+    // в порядке возрастания веса и вызывает visitor(vertex, weight) для каждой
+    template <typename Visitor>
+    void VisitReachable(VertexId from, const Weight& budget, Visitor visitor) const;
+
     const typename Router<Weight>::RoutesInternalData& GetRoutesInternalData() const;
+
+    memory_stats::Report GetMemoryStats() const;
     
 
 private:
@@ -82,6 +133,9 @@ private:
         }
     }
 
+    std::optional<Weight> BuildRouteFromRow(const std::vector<std::optional<RouteInternalData>>& routes_from,
+                                            VertexId to, std::vector<EdgeId>& edges) const;
+
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
     RoutesInternalData routes_internal_data_;
@@ -104,21 +158,200 @@ Router<Weight>::Router(const Graph& graph)
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
+    std::vector<EdgeId> edges;
+    const std::optional<Weight> weight = BuildRoute(from, to, edges);
+    if (!weight) {
+        return std::nullopt;
+    }
+    return RouteInfo{*weight, std::move(edges)};
+}
+
+template <typename Weight>
+std::optional<Weight> Router<Weight>::BuildRoute(VertexId from, VertexId to,
+                                                 std::vector<EdgeId>& edges) const {
+    if (IsOnDemand()) {
+        ShortestPathTree tree;
+        BuildShortestPathTree(from, {to}, tree);
+        return BuildRoute(tree, to, edges);
+    }
+    return BuildRouteFromRow(routes_internal_data_.at(from), to, edges);
+}
+
+template <typename Weight>
+std::optional<Weight> Router<Weight>::BuildRoute(const ShortestPathTree& tree, VertexId to,
+                                                 std::vector<EdgeId>& edges) const {
+    return BuildRouteFromRow(tree.routes, to, edges);
+}
+
+template <typename Weight>
+std::optional<Weight> Router<Weight>::BuildRouteFromRow(
+    const std::vector<std::optional<RouteInternalData>>& routes_from, VertexId to,
+    std::vector<EdgeId>& edges) const {
+    edges.clear();
+    const auto& route_internal_data = routes_from.at(to);
     if (!route_internal_data) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
-    std::vector<EdgeId> edges;
+    const auto& graph_edges = graph_.GetEdges();
     for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
          edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+         edge_id = routes_from[graph_edges[*edge_id].from]->prev_edge)
     {
         edges.push_back(*edge_id);
     }
     std::reverse(edges.begin(), edges.end());
 
-    return RouteInfo{weight, std::move(edges)};
+    return route_internal_data->weight;
+}
+
+template <typename Weight>
+void Router<Weight>::BuildShortestPathTree(VertexId from, const std::vector<VertexId>& targets,
+                                           ShortestPathTree& tree) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    tree.from = from;
+    tree.routes.assign(vertex_count, std::nullopt);
+    std::vector<bool>& settled = tree.settled;
+    settled.assign(vertex_count, false);
+
+    // цели считаются без повторов
+    size_t targets_left = 0;
+    std::vector<bool>& is_target = tree.is_target;
+    is_target.assign(targets.empty() ? 0 : vertex_count, false);
+    for (const VertexId target : targets) {
+        if (!is_target.at(target)) {
+            is_target[target] = true;
+            ++targets_left;
+        }
+    }
+
+    // очередь - двоичная куча в буфере дерева
+    using QueueItem = typename ShortestPathTree::QueueItem;
+    auto greater = [](const QueueItem& lhs, const QueueItem& rhs) {
+        return lhs.key > rhs.key;
+    };
+    std::vector<QueueItem>& queue = tree.queue;
+    queue.clear();
+
+    tree.routes.at(from) = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+    queue.push_back({ZERO_WEIGHT, from, ZERO_WEIGHT});
+    while (!queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), greater);
+        const auto [key, vertex, weight] = queue.back();
+        queue.pop_back();
+        if (settled[vertex]) {
+            continue;
+        }
+        settled[vertex] = true;
+        if (!is_target.empty() && is_target[vertex] && --targets_left == 0) {
+            break;
+        }
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            if (settled[edge.to]) {
+                continue;
+            }
+            const Weight candidate = weight + edge.weight;
+            auto& best = tree.routes[edge.to];
+            if (!best || candidate < best->weight) {
+                best = RouteInternalData{candidate, edge_id};
+                queue.push_back({candidate, edge.to, candidate});
+                std::push_heap(queue.begin(), queue.end(), greater);
+            }
+        }
+    }
+}
+
+template <typename Weight>
+template <typename Heuristic>
+void Router<Weight>::BuildGoalDirectedTree(VertexId from, VertexId to, const Heuristic& heuristic,
+                                           ShortestPathTree& tree) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    tree.from = from;
+    tree.routes.assign(vertex_count, std::nullopt);
+
+    // ключ очереди - оценка полного пути
+    using QueueItem = typename ShortestPathTree::QueueItem;
+    auto greater = [](const QueueItem& lhs, const QueueItem& rhs) {
+        return lhs.key > rhs.key;
+    };
+    std::vector<QueueItem>& queue = tree.queue;
+    queue.clear();
+
+    tree.routes.at(from) = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+    queue.push_back({heuristic(from), from, ZERO_WEIGHT});
+    while (!queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), greater);
+        const auto [estimate, vertex, weight] = queue.back();
+        queue.pop_back();
+        // вес вершины улучшился после добавления, элемент устарел
+        if (tree.routes[vertex]->weight < weight) {
+            continue;
+        }
+        if (vertex == to) {
+            break;
+        }
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            const Weight candidate = weight + edge.weight;
+            auto& best = tree.routes[edge.to];
+            if (!best || candidate < best->weight) {
+                best = RouteInternalData{candidate, edge_id};
+                queue.push_back({candidate + heuristic(edge.to), edge.to, candidate});
+                std::push_heap(queue.begin(), queue.end(), greater);
+            }
+        }
+    }
+}
+
+template <typename Weight>
+bool Router<Weight>::IsOnDemand() const {
+    return routes_internal_data_.empty();
+}
+
+template <typename Weight>
+template <typename Visitor>
+void Router<Weight>::VisitReachable(VertexId from, const Weight& budget, Visitor visitor) const {
+    using QueueItem = std::pair<Weight, VertexId>;
+    auto greater = [](const QueueItem& lhs, const QueueItem& rhs) {
+        return lhs.first > rhs.first;
+    };
+    std::priority_queue<QueueItem, std::vector<QueueItem>, decltype(greater)> queue(greater);
+    std::vector<std::optional<Weight>> weights(graph_.GetVertexCount());
+    std::vector<bool> settled(graph_.GetVertexCount(), false);
+
+    weights.at(from) = ZERO_WEIGHT;
+    queue.push({ZERO_WEIGHT, from});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (settled[vertex]) {
+            continue;
+        }
+        settled[vertex] = true;
+        visitor(vertex, weight);
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Weight candidate = weight + edge.weight;
+            // за пределами бюджета вершины не раскрываются
+            if (budget < candidate || settled[edge.to]) {
+                continue;
+            }
+            auto& best = weights[edge.to];
+            if (!best || candidate < *best) {
+                best = candidate;
+                queue.push({candidate, edge.to});
+            }
+        }
+    }
 }
 
 template <typename Weight>
@@ -127,10 +360,24 @@ Router<Weight>::GetRoutesInternalData() const {
     return routes_internal_data_;
 }
 
+template <typename Weight>
+memory_stats::Report Router<Weight>::GetMemoryStats() const {
+    memory_stats::Report report;
+    memory_stats::ContainerStats& routes = report.emplace_back(
+        memory_stats::Collect("routes_internal_data_", routes_internal_data_));
+    // элементами считаются ячейки матрицы, а не строки
+    routes.elements = 0;
+    for (const auto& row : routes_internal_data_) {
+        routes.elements += row.size();
+        routes.heap_bytes += memory_stats::HeapBytes(row);
+    }
+    return report;
+}
+
 template <typename Weight>
 Router<Weight>::Router(const Graph& graph,
     RoutesInternalData&& routes_internal_data)
     : graph_(graph)
-    , routes_internal_data_(routes_internal_data) {}
+    , routes_internal_data_(std::move(routes_internal_data)) {}
 
 }  // namespace graph
\ No newline at end of file
@@ -1,19 +1,407 @@
 #include "serialization.h"
 
+#include <cmath>
+#include <initializer_list>
+#include <map>
+#include <optional>
+#include <string_view>
+
+#include "parallel.h"
+
+#include <zlib.h>
+
 namespace Serialize
 {
+    namespace {
+        enum WireType {
+            VARINT = 0,
+            FIXED64 = 1,
+            LENGTH_DELIMITED = 2,
+            FIXED32 = 5
+        };
+
+        // nullopt - конец файла перед первым байтом числа
+        std::optional<uint64_t> ReadVarint(std::istream& input) {
+            uint64_t result = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const int byte = input.get();
+                if (byte == std::char_traits<char>::eof()) {
+                    if (shift == 0) {
+                        return std::nullopt;
+                    }
+                    break;
+                }
+                result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return result;
+                }
+            }
+            throw std::runtime_error("Bad base file");
+        }
+        uint32_t Crc32(std::string_view data) {
+            uLong crc = crc32(0L, Z_NULL, 0);
+            // crc32 принимает длину типа uInt
+            while (!data.empty()) {
+                const uInt size = static_cast<uInt>(std::min<size_t>(data.size(), 1u << 30));
+                crc = crc32(crc, reinterpret_cast<const Bytef*>(data.data()), size);
+                data.remove_prefix(size);
+            }
+            return static_cast<uint32_t>(crc);
+        }
+
+        template <typename Int>
+        void WriteLittleEndian(std::ostream& out, Int value) {
+            char bytes[sizeof(Int)];
+            for (size_t i = 0; i < sizeof(Int); ++i) {
+                bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+            }
+            out.write(bytes, sizeof(Int));
+        }
+
+        template <typename Int>
+        Int ReadLittleEndian(std::istream& input) {
+            char bytes[sizeof(Int)];
+            if (!input.read(bytes, sizeof(Int))) {
+                throw std::runtime_error("Bad base file");
+            }
+            Int value = 0;
+            for (size_t i = 0; i < sizeof(Int); ++i) {
+                value |= static_cast<Int>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+            }
+            return value;
+        }
+
+        // nullopt - конец data перед первым байтом числа
+        std::optional<uint64_t> ReadVarint(std::string_view& data) {
+            if (data.empty()) {
+                return std::nullopt;
+            }
+            uint64_t result = 0;
+            for (int shift = 0; shift < 64 && !data.empty(); shift += 7) {
+                const uint8_t byte = static_cast<uint8_t>(data.front());
+                data.remove_prefix(1);
+                result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return result;
+                }
+            }
+            throw std::runtime_error("Bad base file");
+        }
+
+        // Вхождение поля в сериализованном сообщении
+        struct FieldRecord {
+            // тег, длина и значение
+            std::string_view record;
+            // значение поля с разделителем длины
+            std::string_view payload;
+        };
+
+        using FieldsIndex = std::map<int, std::vector<FieldRecord>>;
+
+        // Находит поля верхнего уровня сообщения, не разбирая их значений
+        FieldsIndex SplitFields(std::string_view message) {
+            FieldsIndex result;
+            std::string_view data = message;
+            while (true) {
+                const std::string_view record_begin = data;
+                const std::optional<uint64_t> tag = ReadVarint(data);
+                if (!tag) {
+                    break;
+                }
+                std::string_view payload;
+                switch (*tag & 7) {
+                case VARINT:
+                    ReadVarint(data);
+                    break;
+                case FIXED64:
+                case FIXED32: {
+                    const size_t size = (*tag & 7) == FIXED64 ? 8 : 4;
+                    if (data.size() < size) {
+                        throw std::runtime_error("Bad base file");
+                    }
+                    data.remove_prefix(size);
+                    break;
+                }
+                case LENGTH_DELIMITED: {
+                    const std::optional<uint64_t> size = ReadVarint(data);
+                    if (!size || data.size() < *size) {
+                        throw std::runtime_error("Bad base file");
+                    }
+                    payload = data.substr(0, *size);
+                    data.remove_prefix(*size);
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Bad base file");
+                }
+                result[static_cast<int>(*tag >> 3)].push_back({
+                    record_begin.substr(0, record_begin.size() - data.size()), payload });
+            }
+            return result;
+        }
+
+        const std::vector<FieldRecord>& GetRecords(const FieldsIndex& fields, int field_number) {
+            static const std::vector<FieldRecord> empty;
+            const auto it = fields.find(field_number);
+            return it == fields.end() ? empty : it->second;
+        }
+
+        // Разбирает значения повторяющегося поля-сообщения параллельными частями
+        template <typename Message>
+        std::vector<Message> ParseMessages(const std::vector<FieldRecord>& records, size_t min_chunk) {
+            std::vector<Message> result(records.size());
+            parallel::ForChunks(records.size(), min_chunk, [&records, &result](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    if (!result[i].ParseFromArray(records[i].payload.data(), static_cast<int>(records[i].payload.size()))) {
+                        throw std::runtime_error("Bad base file");
+                    }
+                }
+                });
+            return result;
+        }
+
+        // Разбирает сообщение, составленное только из полей field_numbers
+        template <typename Message>
+        Message ParseFields(const FieldsIndex& fields, std::initializer_list<int> field_numbers) {
+            std::string message;
+            for (const int field_number : field_numbers) {
+                for (const FieldRecord& record : GetRecords(fields, field_number)) {
+                    message += record.record;
+                }
+            }
+            Message result;
+            if (!result.ParseFromString(message)) {
+                throw std::runtime_error("Bad base file");
+            }
+            return result;
+        }
+    } // namespace
+
+    SectionWriter::SectionWriter(std::ostream& out, Codec codec)
+        : out_(out)
+        , codec_(codec) {
+        out_.write(BASE_MAGIC.data(), static_cast<std::streamsize>(BASE_MAGIC.size()));
+    }
+
+    void SectionWriter::Write(int field_number, const google::protobuf::MessageLite& message) {
+        buffer_.clear();
+        if (!message.AppendToString(&buffer_)) {
+            throw std::runtime_error("Can't serialize base section");
+        }
+        const uint32_t checksum = Crc32(buffer_);
+
+        Codec codec = codec_;
+        const std::string* data = &buffer_;
+        if (codec == Codec::ZLIB) {
+            uLongf compressed_size = compressBound(static_cast<uLong>(buffer_.size()));
+            compressed_.resize(compressed_size);
+            if (compress2(reinterpret_cast<Bytef*>(compressed_.data()), &compressed_size,
+                reinterpret_cast<const Bytef*>(buffer_.data()), static_cast<uLong>(buffer_.size()), Z_DEFAULT_COMPRESSION) != Z_OK) {
+                throw std::runtime_error("Can't compress base section");
+            }
+            compressed_.resize(compressed_size);
+            data = &compressed_;
+        }
+        // несжимаемая запись хранится как есть
+        if (data->size() >= buffer_.size()) {
+            codec = Codec::NONE;
+            data = &buffer_;
+        }
+
+        WriteLittleEndian(out_, static_cast<uint32_t>(field_number));
+        WriteLittleEndian(out_, static_cast<uint32_t>(codec));
+        WriteLittleEndian(out_, static_cast<uint64_t>(buffer_.size()));
+        WriteLittleEndian(out_, static_cast<uint64_t>(data->size()));
+        WriteLittleEndian(out_, checksum);
+        out_.write(data->data(), static_cast<std::streamsize>(data->size()));
+        if (!out_) {
+            throw std::runtime_error("Can't write base file");
+        }
+    }
+
+    void Deserializer::IndexSections() {
+        std::ifstream input_file(open_path_, std::ios::binary);
+        if (!input_file) {
+            throw std::runtime_error("Can't open file? bad path?");
+        }
+
+        std::string magic(BASE_MAGIC.size(), '\0');
+        input_file.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+        if (input_file && (magic == BASE_MAGIC || magic == BASE_MAGIC_V1)) {
+            const bool has_codec = magic == BASE_MAGIC;
+            while (input_file.peek() != std::char_traits<char>::eof()) {
+                const uint32_t field_number = ReadLittleEndian<uint32_t>(input_file);
+                Section section;
+                if (has_codec) {
+                    const uint32_t codec = ReadLittleEndian<uint32_t>(input_file);
+                    if (codec > static_cast<uint32_t>(Codec::ZLIB)) {
+                        throw std::runtime_error("Unknown base codec");
+                    }
+                    section.codec = static_cast<Codec>(codec);
+                    section.size = static_cast<size_t>(ReadLittleEndian<uint64_t>(input_file));
+                    section.stored_size = static_cast<size_t>(ReadLittleEndian<uint64_t>(input_file));
+                    section.checksum = ReadLittleEndian<uint32_t>(input_file);
+                }
+                else {
+                    section.size = static_cast<size_t>(ReadLittleEndian<uint64_t>(input_file));
+                    section.stored_size = section.size;
+                }
+                section.offset = static_cast<std::streamoff>(input_file.tellg());
+                sections_[static_cast<int>(field_number)].push_back(section);
+                input_file.seekg(static_cast<std::streamoff>(section.stored_size), std::ios::cur);
+                if (!input_file) {
+                    throw std::runtime_error("Bad base file");
+                }
+            }
+            return;
+        }
+
+        // база старого формата - сериализованный TransportBase;
+        // значения полей пропускаются без чтения
+        input_file.clear();
+        input_file.seekg(0);
+        while (const std::optional<uint64_t> tag = ReadVarint(input_file)) {
+            const int field_number = static_cast<int>(*tag >> 3);
+            switch (*tag & 7) {
+            case VARINT:
+                ReadVarint(input_file);
+                break;
+            case FIXED64:
+                input_file.seekg(8, std::ios::cur);
+                break;
+            case FIXED32:
+                input_file.seekg(4, std::ios::cur);
+                break;
+            case LENGTH_DELIMITED: {
+                const std::optional<uint64_t> size = ReadVarint(input_file);
+                if (!size) {
+                    throw std::runtime_error("Bad base file");
+                }
+                Section section;
+                section.offset = static_cast<std::streamoff>(input_file.tellg());
+                section.size = static_cast<size_t>(*size);
+                section.stored_size = section.size;
+                sections_[field_number].push_back(section);
+                input_file.seekg(static_cast<std::streamoff>(*size), std::ios::cur);
+                break;
+            }
+            default:
+                throw std::runtime_error("Bad base file");
+            }
+            if (!input_file) {
+                throw std::runtime_error("Bad base file");
+            }
+        }
+    }
+
+    template <typename Message>
+    Message Deserializer::ReadSection(int field_number) const {
+        Message result;
+        if (!result.ParseFromString(ReadSectionBytes(field_number))) {
+            throw std::runtime_error("Bad base file");
+        }
+        return result;
+    }
+
+    std::string Deserializer::ReadSectionBytes(int field_number) const {
+        std::string result;
+        const auto it = sections_.find(field_number);
+        if (it == sections_.end()) {
+            return result;
+        }
+        const std::vector<Section>& sections = it->second;
+
+        // повторные вхождения поля-сообщения записываются подряд: так они сливаются при разборе
+        std::vector<size_t> offsets(sections.size() + 1, 0);
+        for (size_t i = 0; i < sections.size(); ++i) {
+            offsets[i + 1] = offsets[i] + sections[i].size;
+        }
+        result.resize(offsets.back());
+
+        // файл читается последовательно, несжатые записи - сразу на место
+        std::vector<std::string> compressed(sections.size());
+        std::ifstream input_file(open_path_, std::ios::binary);
+        for (size_t i = 0; i < sections.size(); ++i) {
+            const Section& section = sections[i];
+            char* destination = result.data() + offsets[i];
+            if (section.codec != Codec::NONE) {
+                compressed[i].resize(section.stored_size);
+                destination = compressed[i].data();
+            }
+            input_file.seekg(section.offset);
+            if (!input_file.read(destination, static_cast<std::streamsize>(section.stored_size))) {
+                throw std::runtime_error("Bad base file");
+            }
+        }
+
+        parallel::ForChunks(sections.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Section& section = sections[i];
+                char* destination = result.data() + offsets[i];
+                if (section.codec == Codec::ZLIB) {
+                    uLongf size = static_cast<uLongf>(section.size);
+                    if (uncompress(reinterpret_cast<Bytef*>(destination), &size,
+                        reinterpret_cast<const Bytef*>(compressed[i].data()), static_cast<uLong>(compressed[i].size())) != Z_OK
+                        || size != section.size) {
+                        throw std::runtime_error("Bad base file");
+                    }
+                    std::string().swap(compressed[i]);
+                }
+                if (section.checksum && *section.checksum != Crc32({ destination, section.size })) {
+                    throw std::runtime_error("Base file checksum mismatch");
+                }
+            }
+            });
+        return result;
+    }
+
     catalogue::TransportCatalogue Deserializer::GetTransportCatalogue() const {
+        using tc_pb::TransportCatalogue;
         catalogue::TransportCatalogue result;
 
-        const tc_pb::TransportCatalogue& pb_catalogue = pb_base_.cat();
+        const std::string bytes = ReadSectionBytes(tc_pb::TransportBase::kCatFieldNumber);
+        const FieldsIndex fields = SplitFields(bytes);
+        const std::vector<tc_pb::Stop> pb_stops = ParseMessages<tc_pb::Stop>(
+            GetRecords(fields, TransportCatalogue::kStopsFieldNumber), 4096);
+        const std::vector<tc_pb::Bus> pb_buses = ParseMessages<tc_pb::Bus>(
+            GetRecords(fields, TransportCatalogue::kBusesFieldNumber), 256);
+        const std::vector<tc_pb::IntervalToDistance> pb_intervals = ParseMessages<tc_pb::IntervalToDistance>(
+            GetRecords(fields, TransportCatalogue::kIntervalsToDistanceFieldNumber), 4096);
+        const TransportCatalogue pb_catalogue = ParseFields<TransportCatalogue>(fields, {
+            TransportCatalogue::kNamesFieldNumber,
+            TransportCatalogue::kStopBusesOffsetsFieldNumber,
+            TransportCatalogue::kStopBusesFieldNumber });
+
+        // все имена копируются в пул одним блоком, остановки и автобусы ссылаются на него.
+        // В базах старого формата блока нет, имена хранятся в самих остановках и автобусах
+        const bool names_inline = pb_catalogue.names().empty();
+        std::string all_names;
+        if (names_inline) {
+            for (const auto& pb_stop : pb_stops) {
+                all_names += pb_stop.name();
+            }
+            for (const auto& pb_bus : pb_buses) {
+                all_names += pb_bus.name();
+            }
+        }
+        for (const std::string& names_part : pb_catalogue.names()) {
+            all_names += names_part;
+        }
+        std::string_view names = result.SetNames(all_names, pb_stops.size() + pb_buses.size());
+        auto take_name = [&names, names_inline](const auto& pb_item) {
+            const size_t size = names_inline ? pb_item.name().size() : pb_item.name_size();
+            std::string_view name = names.substr(0, size);
+            names.remove_prefix(name.size());
+            return name;
+        };
 
         {
             std::deque<Stop> stops;
             std::map<std::string_view, StopPtr> stopname_to_stop;
-            for (const auto& pb_stop : pb_catalogue.stops()) {
+            for (const auto& pb_stop : pb_stops) {
                 Stop& emplaced = stops.emplace_back(
                     Stop{
-                        std::string(pb_stop.name()),
+                        take_name(pb_stop),
                         geo::Coordinates{
                             pb_stop.coordinates().lat(),
                             pb_stop.coordinates().lng()
@@ -22,17 +410,20 @@ namespace Serialize
                     }
                 );
 
-                stopname_to_stop[std::string_view(emplaced.name_)] = &emplaced;
+                stopname_to_stop[emplaced.name_] = &emplaced;
             }
 
             result.SetStops(std::move(stops));
             result.SetStopnameToStop(std::move(stopname_to_stop));
         }
-        {
+
+        // автобусы и расстояния зависят только от остановок и собираются одновременно
+        auto decode_buses = [&] {
             std::deque<Bus> buses;
             std::map<std::string_view, BusPtr> busname_to_bus;
-            for (const auto& pb_bus : pb_catalogue.buses()) {
+            for (const auto& pb_bus : pb_buses) {
                 std::vector<StopPtr> stops;
+                stops.reserve(pb_bus.stops_size());
                 for (int stop_id : pb_bus.stops()) {
                     assert(result.GetStops().at(stop_id).id == stop_id);
                     stops.push_back(&(result.GetStops().at(stop_id)));
@@ -46,41 +437,51 @@ namespace Serialize
                     bus_type = BusType::ORDINARY;
                 }
                 Bus current_bus{
-                    std::string(pb_bus.name()),
+                    take_name(pb_bus),
                     std::move(stops),
                     bus_type,
-                    pb_bus.id()
+                    pb_bus.id(),
+                    { pb_bus.road_forward().begin(), pb_bus.road_forward().end() },
+                    { pb_bus.road_backward().begin(), pb_bus.road_backward().end() },
+                    { pb_bus.geo().begin(), pb_bus.geo().end() }
                 };
                 Bus& emlplaced = buses.emplace_back(std::move(current_bus));
 
-                busname_to_bus[std::string_view(emlplaced.name_)] = &(emlplaced);
+                busname_to_bus[emlplaced.name_] = &(emlplaced);
             }
 
             result.SetBuses(std::move(buses));
             result.SetBusnameToBus(std::move(busname_to_bus));
-        }
-        {
-            std::unordered_map<StopPtr, std::set<BusPtr>> stops_to_buses;
-
-            for (const auto& stop_to_buses : pb_catalogue.stops_to_buses()) {
-                int stop_id = stop_to_buses.stop_id();
-                StopPtr stop_ptr = &(result.GetStops().at(stop_id));
-                assert(stop_id == stop_ptr->id);
 
-                std::set<BusPtr> current_stop_buses;
-                for (int bus_id : stop_to_buses.bus_id()) {
-                    BusPtr bus_ptr = &(result.GetBuses().at(bus_id));
-                    assert(bus_id == bus_ptr->id);
-                    stops_to_buses[stop_ptr].insert(bus_ptr);
-                }
+            // базы старого формата хранят автобусы остановок иначе; списки строятся заново по автобусам
+            if (pb_catalogue.stop_buses_offsets().empty() && pb_catalogue.stop_buses().empty()) {
+                result.BuildStopBuses();
+                return;
+            }
+            std::vector<uint32_t> stop_buses_offsets(pb_catalogue.stop_buses_offsets().begin(), pb_catalogue.stop_buses_offsets().end());
+            std::vector<BusPtr> stop_buses;
+            stop_buses.reserve(pb_catalogue.stop_buses_size());
+            for (int bus_id : pb_catalogue.stop_buses()) {
+                BusPtr bus_ptr = &(result.GetBuses().at(bus_id));
+                assert(bus_id == bus_ptr->id);
+                stop_buses.push_back(bus_ptr);
             }
 
-            result.SetStopsToBuses(std::move(stops_to_buses));
-        }
-        {
+            // смещения задают диапазоны в stop_buses и не должны выходить за его пределы
+            const bool offsets_valid = stop_buses_offsets.size() == result.GetStops().size() + 1
+                && stop_buses_offsets.front() == 0
+                && std::is_sorted(stop_buses_offsets.begin(), stop_buses_offsets.end())
+                && stop_buses_offsets.back() == stop_buses.size();
+            if (!offsets_valid) {
+                throw std::runtime_error("Bad base file");
+            }
+            result.SetStopBuses(std::move(stop_buses_offsets), std::move(stop_buses));
+        };
+        auto decode_distances = [&] {
             std::unordered_map<std::pair<StopPtr, StopPtr>, uint64_t, DistanceHasher> intervals_to_distance;
+            intervals_to_distance.reserve(pb_intervals.size());
 
-            for (const auto& interval : pb_catalogue.intervals_to_distance()) {
+            for (const auto& interval : pb_intervals) {
                 int from_id = interval.from_id();
                 int to_id = interval.to_id();
                 int64_t distance = interval.distance();
@@ -93,15 +494,25 @@ namespace Serialize
             }
 
             result.SetDistanceBetweenStops(std::move(intervals_to_distance));
-        }
+        };
+        parallel::Invoke(decode_buses, decode_distances);
+        // в базах старого формата у автобусов нет накопленных расстояний
+        result.FillMissingBusDistances();
+
         return result;
     }
-
     catalogue::RoutingSettings Deserializer::GetRoutingSettings() const {
         catalogue::RoutingSettings result;
 
-        result.bus_velocity = pb_base_.routing_settings().bus_velocity();
-        result.bus_wait_time = pb_base_.routing_settings().bus_wait_time();
+        const tc_pb::RoutingSettings pb_routing_settings = ReadSection<tc_pb::RoutingSettings>(tc_pb::TransportBase::kRoutingSettingsFieldNumber);
+
+        result.bus_velocity = pb_routing_settings.bus_velocity();
+        result.bus_wait_time = pb_routing_settings.bus_wait_time();
+        result.algorithm = static_cast<catalogue::RouterAlgorithm>(pb_routing_settings.algorithm());
+        if (pb_routing_settings.landmark_count() != 0) {
+            result.landmark_count = pb_routing_settings.landmark_count();
+        }
+        result.hub_labels = pb_routing_settings.hub_labels();
 
         return result;
     }
@@ -109,7 +520,7 @@ namespace Serialize
     renderer::RenderSettings Deserializer::GetRenderSettings() const {
         renderer::RenderSettings result;
 
-        const tc_pb::RenderSettings& pb_render_settings = pb_base_.rendder_settings();
+        const tc_pb::RenderSettings pb_render_settings = ReadSection<tc_pb::RenderSettings>(tc_pb::TransportBase::kRendderSettingsFieldNumber);
 
         result.width = pb_render_settings.width();
         result.height = pb_render_settings.height();
@@ -136,6 +547,9 @@ namespace Serialize
             result.color_palette.push_back(ExtractSVGColorFromPBColor(pb_color));
         }
 
+        result.simplify_tolerance = pb_render_settings.simplify_tolerance();
+        result.zoom_levels.assign(pb_render_settings.zoom_levels().begin(), pb_render_settings.zoom_levels().end());
+
         return result;
     }
 
@@ -169,18 +583,33 @@ namespace Serialize
     }
 
     catalogue::TransportRouter Deserializer::GetTransportRouter(const catalogue::TransportCatalogue& catalogue) const {
+        using tc_pb::TransportRouter;
         catalogue::TransportRouter result(GetRoutingSettings(), catalogue);
 
+        const std::string bytes = ReadSectionBytes(tc_pb::TransportBase::kTransportRouterFieldNumber);
+        const FieldsIndex fields = SplitFields(bytes);
+        const TransportRouter pb_transport_router = ParseFields<TransportRouter>(fields, { TransportRouter::kVertexIndexToStopFieldNumber });
+        const std::vector<tc_pb::BusId> pb_edge_index_to_bus = ParseMessages<tc_pb::BusId>(
+            GetRecords(fields, TransportRouter::kEdgeIndexToBusFieldNumber), 16384);
+        // рёбра графа разбираются параллельно, списки смежности восстанавливает AddEdge
+        std::vector<FieldRecord> edge_records;
+        for (const FieldRecord& graph_record : GetRecords(fields, TransportRouter::kRouteGraphFieldNumber)) {
+            const FieldsIndex graph_fields = SplitFields(graph_record.payload);
+            const std::vector<FieldRecord>& records = GetRecords(graph_fields, tc_pb::DirectedWeightedGraph::kEdgesFieldNumber);
+            edge_records.insert(edge_records.end(), records.begin(), records.end());
+        }
+        const std::vector<tc_pb::Edge> pb_edges = ParseMessages<tc_pb::Edge>(edge_records, 16384);
+
         std::deque<StopPtr> vertex_index_to_stop;
         std::map<std::string_view, graph::VertexId> stopname_to_vertex_id;
 
-        for (const int32_t stop_id : pb_base_.transport_router().vertex_index_to_stop()) {
+        for (const int32_t stop_id : pb_transport_router.vertex_index_to_stop()) {
             StopPtr& emplaced = vertex_index_to_stop.emplace_back(&catalogue.GetStops().at(stop_id));
             stopname_to_vertex_id[emplaced->name_] = 2 * stop_id;
         }
 
         std::deque<BusPtr> edge_index_to_bus;
-        for (auto bus_id : pb_base_.transport_router().edge_index_to_bus()) {
+        for (const tc_pb::BusId& bus_id : pb_edge_index_to_bus) {
             if (bus_id.isinitialized()) {
                 edge_index_to_bus.emplace_back(&catalogue.GetBuses().at(bus_id.bus_id()));
             }
@@ -189,12 +618,25 @@ namespace Serialize
             }
         }
 
+        // в базах без расстояний рёбер расстояние восстанавливается по времени поездки
+        const double bus_velocity = result.GetRoutingSettings().bus_velocity;
+        std::vector<uint64_t> edge_distances;
+        edge_distances.reserve(pb_edges.size());
+        for (size_t edge_id = 0; edge_id < pb_edges.size(); ++edge_id) {
+            const tc_pb::Edge& pb_edge = pb_edges[edge_id];
+            const bool is_wait = edge_id >= edge_index_to_bus.size() || edge_index_to_bus[edge_id] == nullptr;
+            edge_distances.push_back(pb_edge.distance() != 0 || is_wait
+                ? pb_edge.distance()
+                : static_cast<uint64_t>(std::llround(pb_edge.weight().time() * bus_velocity)));
+        }
+
         result.SetVertexIndexToStop(std::move(vertex_index_to_stop));
         result.SetStopnameToVertexId(std::move(stopname_to_vertex_id));
         result.SetEdgeIndexToBus(std::move(edge_index_to_bus));
+        result.SetEdgeDistances(std::move(edge_distances));
 
-        graph::DirectedWeightedGraph<BusRouteWeight> route_graph(vertex_index_to_stop.size());
-        for (const auto& pb_edge : pb_base_.transport_router().route_graph().edges()) {
+        graph::DirectedWeightedGraph<BusRouteWeight> route_graph(result.GetVertexIndexToStop().size());
+        for (const tc_pb::Edge& pb_edge : pb_edges) {
 
             route_graph.AddEdge(
                 graph::Edge<BusRouteWeight>{
@@ -215,32 +657,145 @@ namespace Serialize
     graph::Router<BusRouteWeight> Deserializer::GetRouter(const graph::DirectedWeightedGraph<BusRouteWeight>& graph) const {
 
         graph::Router<BusRouteWeight>::RoutesInternalData routes_internal_data;
+        const std::string bytes = ReadSectionBytes(tc_pb::TransportBase::kRouterFieldNumber);
+        const FieldsIndex fields = SplitFields(bytes);
+        const std::vector<FieldRecord>& row_records = GetRecords(fields, tc_pb::Router::kRoutesInternalDataFieldNumber);
+        // без матрицы маршруты ищутся по запросу
+        if (row_records.empty()) {
+            return graph::Router<BusRouteWeight>(graph, std::move(routes_internal_data));
+        }
         routes_internal_data.resize(graph.GetVertexCount());
 
-        const tc_pb::Router& pb_router = pb_base_.router();
-        size_t from_index = 0;
-        for (const tc_pb::RouteInternalDataRow pb_route_internal_data_row : pb_router.routes_internal_data()) {
-            routes_internal_data[from_index].resize(graph.GetVertexCount());
-            size_t to_index = 0;
-            for (const tc_pb::RouteInternalData& pb_route_internal_data : pb_route_internal_data_row.route_internal_data_row()) {
-                if (pb_route_internal_data.has_weight()) {
-                    routes_internal_data[from_index][to_index] = {
-                        {pb_route_internal_data.weight().time(), pb_route_internal_data.weight().span()},
-                        std::nullopt
-                    };
-                    if (pb_route_internal_data.has_prev_edge()) {
-                        routes_internal_data[from_index][to_index].value().prev_edge = pb_route_internal_data.prev_edge().prev_edge_id();
+        // строки матрицы независимы и разбираются параллельными частями
+        parallel::ForChunks(std::min(row_records.size(), routes_internal_data.size()), 16,
+            [&row_records, &routes_internal_data, &graph](size_t begin, size_t end) {
+            tc_pb::RouteInternalDataRow pb_route_internal_data_row;
+            for (size_t from_index = begin; from_index < end; ++from_index) {
+                const std::string_view payload = row_records[from_index].payload;
+                if (!pb_route_internal_data_row.ParseFromArray(payload.data(), static_cast<int>(payload.size()))) {
+                    throw std::runtime_error("Bad base file");
+                }
+                auto& row = routes_internal_data[from_index];
+                row.resize(graph.GetVertexCount());
+                size_t to_index = 0;
+                for (const tc_pb::RouteInternalData& pb_route_internal_data : pb_route_internal_data_row.route_internal_data_row()) {
+                    if (pb_route_internal_data.has_weight()) {
+                        row.at(to_index) = {
+                            {pb_route_internal_data.weight().time(), pb_route_internal_data.weight().span()},
+                            std::nullopt
+                        };
+                        if (pb_route_internal_data.has_prev_edge()) {
+                            row[to_index].value().prev_edge = pb_route_internal_data.prev_edge().prev_edge_id();
+                        }
                     }
+
+                    ++to_index;
                 }
+            }
+            });
+
+        graph::Router<BusRouteWeight> result(graph, std::move(routes_internal_data));
+
+        return result;
+    }
+
+    catalogue::Timetable Deserializer::GetTimetable(const catalogue::TransportCatalogue& catalogue) const {
+        const tc_pb::Timetable pb_timetable = ReadSection<tc_pb::Timetable>(tc_pb::TransportBase::kTimetableFieldNumber);
+
+        const int connections_count = pb_timetable.connection_from_size();
+        if (pb_timetable.connection_to_size() != connections_count || pb_timetable.connection_trip_size() != connections_count
+            || pb_timetable.connection_position_size() != connections_count
+            || pb_timetable.connection_departure_size() != connections_count
+            || pb_timetable.connection_arrival_size() != connections_count) {
+            throw std::runtime_error("Bad base file");
+        }
+        std::vector<BusPtr> trip_buses;
+        trip_buses.reserve(pb_timetable.trip_buses_size());
+        for (const int32_t bus_id : pb_timetable.trip_buses()) {
+            trip_buses.push_back(&catalogue.GetBuses().at(bus_id));
+        }
 
-                ++to_index;
+        // ConnectionScanner индексирует по id остановок и номерам рейсов без проверок
+        const size_t stops_count = catalogue.GetStops().size();
+        std::vector<catalogue::Connection> connections(connections_count);
+        for (int i = 0; i < connections_count; ++i) {
+            connections[i] = {
+                pb_timetable.connection_from(i),
+                pb_timetable.connection_to(i),
+                pb_timetable.connection_trip(i),
+                pb_timetable.connection_position(i),
+                pb_timetable.connection_departure(i),
+                pb_timetable.connection_arrival(i)
+            };
+            if (connections[i].from >= stops_count || connections[i].to >= stops_count || connections[i].trip >= trip_buses.size()) {
+                throw std::runtime_error("Bad base file");
             }
+        }
+
+        catalogue::Timetable result;
+        result.SetConnections(std::move(connections), std::move(trip_buses));
+        return result;
+    }
+
+    catalogue::Landmarks Deserializer::GetLandmarks() const {
+        const tc_pb::Landmarks pb_landmarks = ReadSection<tc_pb::Landmarks>(tc_pb::TransportBase::kLandmarksFieldNumber);
 
-            ++from_index;
+        auto read_times = [](const google::protobuf::RepeatedPtrField<std::string>& parts) {
+            std::vector<uint16_t> times;
+            for (const std::string& part : parts) {
+                if (part.size() % 2 != 0) {
+                    throw std::runtime_error("Bad base file");
+                }
+                for (size_t i = 0; i < part.size(); i += 2) {
+                    times.push_back(static_cast<uint16_t>(static_cast<uint8_t>(part[i]) | (static_cast<uint8_t>(part[i + 1]) << 8)));
+                }
+            }
+            return times;
+        };
+        std::vector<uint32_t> landmark_stops(pb_landmarks.landmark_stops().begin(), pb_landmarks.landmark_stops().end());
+        std::vector<uint16_t> from_landmarks = read_times(pb_landmarks.from_landmarks());
+        std::vector<uint16_t> to_landmarks = read_times(pb_landmarks.to_landmarks());
+        // LandmarkLowerBound обращается к строкам остановок без проверок
+        if (from_landmarks.size() != to_landmarks.size()
+            || (landmark_stops.empty() ? !from_landmarks.empty() : from_landmarks.size() % landmark_stops.size() != 0)) {
+            throw std::runtime_error("Bad base file");
         }
 
-        graph::Router<BusRouteWeight> result(graph, std::move(routes_internal_data));
+        catalogue::Landmarks result;
+        result.Set(pb_landmarks.time_quantum(), std::move(landmark_stops), std::move(from_landmarks), std::move(to_landmarks));
+        return result;
+    }
+
+    catalogue::HubLabels Deserializer::GetHubLabels(const catalogue::TransportCatalogue& catalogue) const {
+        const tc_pb::HubLabels pb_labels = ReadSection<tc_pb::HubLabels>(tc_pb::TransportBase::kHubLabelsFieldNumber);
+        if (pb_labels.out_offsets().empty() && pb_labels.in_offsets().empty()) {
+            return {};
+        }
 
+        // HubLabels::GetRouteTime сливает метки без проверок границ: каждая метка
+        // должна кончаться SENTINEL, а остановок должно быть столько же, сколько в справочнике
+        auto check_labels = [stops_count = catalogue.GetStops().size()](const google::protobuf::RepeatedField<uint32_t>& offsets,
+            const google::protobuf::RepeatedField<uint32_t>& hubs, const google::protobuf::RepeatedField<double>& times) {
+            if (static_cast<size_t>(offsets.size()) != stops_count + 1 || offsets[0] != 0
+                || offsets[offsets.size() - 1] != static_cast<uint32_t>(hubs.size()) || hubs.size() != times.size()) {
+                throw std::runtime_error("Bad base file");
+            }
+            for (int i = 1; i < offsets.size(); ++i) {
+                if (offsets[i] <= offsets[i - 1] || hubs[offsets[i] - 1] != catalogue::HubLabels::SENTINEL) {
+                    throw std::runtime_error("Bad base file");
+                }
+            }
+        };
+        check_labels(pb_labels.out_offsets(), pb_labels.out_hubs(), pb_labels.out_times());
+        check_labels(pb_labels.in_offsets(), pb_labels.in_hubs(), pb_labels.in_times());
+
+        catalogue::HubLabels result;
+        result.Set({ pb_labels.out_offsets().begin(), pb_labels.out_offsets().end() },
+            { pb_labels.out_hubs().begin(), pb_labels.out_hubs().end() },
+            { pb_labels.out_times().begin(), pb_labels.out_times().end() },
+            { pb_labels.in_offsets().begin(), pb_labels.in_offsets().end() },
+            { pb_labels.in_hubs().begin(), pb_labels.in_hubs().end() },
+            { pb_labels.in_times().begin(), pb_labels.in_times().end() });
         return result;
     }
 
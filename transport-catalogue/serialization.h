@@ -1,19 +1,58 @@
 #pragma once
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <variant>
 
 #include "transport_catalogue.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+#include "timetable.h"
+#include "landmarks.h"
+#include "hub_labels.h"
 #include "transport_catalogue.pb.h"
 #include "router.h"
 
 namespace Serialize {
+    // Сжатие записей базы
+    enum class Codec : uint32_t {
+        NONE = 0,
+        ZLIB = 1
+    };
+
     struct SerializeSettings {
         std::string file;
+        Codec codec = Codec::NONE;
+    };
+
+    // Формат файла базы: заголовок BASE_MAGIC, затем записи разделов
+    // [номер поля TransportBase: uint32][кодек: uint32][длина сообщения: uint64]
+    // [длина данных: uint64][CRC-32 сообщения: uint32][данные], числа little-endian.
+    // Каждая запись сжимается независимо. Большие разделы пишутся несколькими записями,
+    // сообщения записей одного поля сливаются
+    inline const std::string_view BASE_MAGIC{ "TCBASE\x00\x02", 8 };
+    // Записи [номер поля: uint32][длина: uint64][сообщение] без сжатия и контрольной суммы.
+    // Файл без заголовка читается как один сериализованный TransportBase
+    inline const std::string_view BASE_MAGIC_V1{ "TCBASE\x00\x01", 8 };
+
+    // Пишет заголовок и записи разделов в поток по мере их построения
+    class SectionWriter {
+    public:
+        SectionWriter(std::ostream& out, Codec codec);
+        void Write(int field_number, const google::protobuf::MessageLite& message);
+
+    private:
+        std::ostream& out_;
+        Codec codec_;
+        // переиспользуются между записями
+        std::string buffer_;
+        std::string compressed_;
     };
 
     class Serializer {
@@ -24,102 +63,69 @@ namespace Serialize {
             const catalogue::TransportRouter& transport_router,
             const renderer::RenderSettings& render_settings,
             const SerializeSettings serialization_settings,
-            const graph::Router<BusRouteWeight>& router)
+            const graph::Router<BusRouteWeight>& router,
+            const catalogue::Timetable& timetable,
+            const catalogue::Landmarks& landmarks,
+            const catalogue::HubLabels& hub_labels)
             : catalogue_(catalogue)
             , routing_settings_(transport_router.GetRoutingSettings())
             , render_settings_(render_settings)
             , serialize_settings_(serialization_settings)
             , transport_router_(transport_router)
             , router_(router)
+            , timetable_(timetable)
+            , landmarks_(landmarks)
+            , hub_labels_(hub_labels)
         {
-            tc_pb::TransportCatalogue pb_catalogue_;
-            
-            for (const auto& stop : catalogue_.GetStops()) {
-                tc_pb::Stop pb_stop;
-                pb_stop.set_id(stop.id);
-                pb_stop.set_name(stop.name_);
-                pb_stop.mutable_coordinates()->set_lat(stop.cordinates_.lat);
-                pb_stop.mutable_coordinates()->set_lng(stop.cordinates_.lng);
-                pb_catalogue_.mutable_stops()->Add(std::move(pb_stop));
-            }
-
-            for (const auto& bus : catalogue_.GetBuses()) {
-                tc_pb::Bus pb_bus;
-                pb_bus.set_id(bus.id);
-                pb_bus.set_name(bus.name_);
-
-                for (const auto& stop : bus.stops_) {
-                    pb_bus.add_stops(stop->id);
-                }
-
-                switch (bus.bus_type_)
-                {
-                case BusType::ORDINARY:
-                    pb_bus.set_bus_type_cycled(false);
-                    break;
-                case BusType::CYCLED:
-                    pb_bus.set_bus_type_cycled(true);
-                    break;
-                default:
-                    break;
-                }
-                pb_catalogue_.mutable_buses()->Add(std::move(pb_bus));
-            }
-
-            for (const auto& stop_to_buses : catalogue_.GetStopsToBuses()) {
-                tc_pb::StopToBuses pb_stop_to_buses;
-
-                int stop_id = stop_to_buses.first->id;
-                pb_stop_to_buses.set_stop_id(stop_id);
+        }
 
-                const std::set<BusPtr>& buses = stop_to_buses.second;
-                for (const auto& bus : buses) {
-                    pb_stop_to_buses.mutable_bus_id()->Add(bus->id);
-                }
-                pb_catalogue_.mutable_stops_to_buses()->Add(std::move(pb_stop_to_buses));
+        // Разделы строятся и пишутся частями, в памяти одновременно находится одна запись
+        void SaveTo(const std::filesystem::path& path) const {
+            std::ofstream out(path, std::ios::binary);
+            if (!out) {
+                throw std::runtime_error("Can't open file? bad path?");
             }
+            SectionWriter writer(out, serialize_settings_.codec);
 
-            for (const auto& interval_to_distance : catalogue_.GetIntervalsToDistance()) {
-                tc_pb::IntervalToDistance pb_interval_to_distance;
-                int from_id = interval_to_distance.first.first->id;
-                int to_id = interval_to_distance.first.second->id;
-                int64_t distance = interval_to_distance.second;
-                pb_interval_to_distance.set_from_id(from_id);
-                pb_interval_to_distance.set_to_id(to_id);
-                pb_interval_to_distance.set_distance(distance);
-                pb_catalogue_.mutable_intervals_to_distance()->Add(std::move(pb_interval_to_distance));
-            }
+            WriteCatalogue(writer);
 
-            *pb_base_.mutable_cat() = std::move(pb_catalogue_);
+            WriteRoutingSettings(writer);
 
-            FillRoutingSettings();
+            WriteRenderSettings(writer);
 
-            FillRenderSettings();
+            WriteTransportRouter(writer);
 
-            FillTransportRouter();
+            WriteRouter(writer);
 
-            FillRouter();
-        }
+            WriteTimetable(writer);
 
-        void SaveTo(const std::filesystem::path& path) const {
-            std::ofstream out(path, std::ios::binary);
+            WriteLandmarks(writer);
 
-            pb_base_.SerializeToOstream(&out);
+            WriteHubLabels(writer);
         }
 
         void Save() const {
-            std::ofstream out(std::filesystem::path(serialize_settings_.file), std::ios::binary);
-            pb_base_.SerializeToOstream(&out);
+            SaveTo(std::filesystem::path(serialize_settings_.file));
         }
 
     private:
+        // число элементов в одной записи раздела
+        static constexpr size_t STOPS_PER_RECORD = 4096;
+        static constexpr size_t BUSES_PER_RECORD = 256;
+        static constexpr size_t VALUES_PER_RECORD = 65536;
+        // ячеек таблицы graph::Router в одной записи (не меньше одной строки)
+        static constexpr size_t ROUTER_CELLS_PER_RECORD = 1 << 20;
+
         const catalogue::TransportCatalogue& catalogue_;
         const catalogue::RoutingSettings& routing_settings_;
-        const renderer::RenderSettings& render_settings_;
+        // копия: настройки часто передаются временным объектом
+        const renderer::RenderSettings render_settings_;
         const SerializeSettings serialize_settings_;
         const catalogue::TransportRouter& transport_router_;
         const graph::Router<BusRouteWeight>& router_;
-        tc_pb::TransportBase pb_base_;
+        const catalogue::Timetable& timetable_;
+        const catalogue::Landmarks& landmarks_;
+        const catalogue::HubLabels& hub_labels_;
 
 
         struct RenderSettingsColorVisitor {
@@ -147,16 +153,92 @@ namespace Serialize {
             }
         };
 
-        void FillRoutingSettings() {
+        void WriteCatalogue(SectionWriter& writer) const {
+            const int field_number = tc_pb::TransportBase::kCatFieldNumber;
+
+            const std::deque<Stop>& stops = catalogue_.GetStops();
+            for (size_t begin = 0; begin < stops.size(); begin += STOPS_PER_RECORD) {
+                tc_pb::TransportCatalogue pb_catalogue;
+                std::string& names = *pb_catalogue.add_names();
+                for (size_t i = begin; i < std::min(stops.size(), begin + STOPS_PER_RECORD); ++i) {
+                    const Stop& stop = stops[i];
+                    tc_pb::Stop& pb_stop = *pb_catalogue.add_stops();
+                    pb_stop.set_id(stop.id);
+                    pb_stop.set_name_size(stop.name_.size());
+                    names += stop.name_;
+                    pb_stop.mutable_coordinates()->set_lat(stop.cordinates_.lat);
+                    pb_stop.mutable_coordinates()->set_lng(stop.cordinates_.lng);
+                }
+                writer.Write(field_number, pb_catalogue);
+            }
+
+            const std::deque<Bus>& buses = catalogue_.GetBuses();
+            for (size_t begin = 0; begin < buses.size(); begin += BUSES_PER_RECORD) {
+                tc_pb::TransportCatalogue pb_catalogue;
+                std::string& names = *pb_catalogue.add_names();
+                for (size_t i = begin; i < std::min(buses.size(), begin + BUSES_PER_RECORD); ++i) {
+                    const Bus& bus = buses[i];
+                    tc_pb::Bus& pb_bus = *pb_catalogue.add_buses();
+                    pb_bus.set_id(bus.id);
+                    pb_bus.set_name_size(bus.name_.size());
+                    names += bus.name_;
+
+                    for (const auto& stop : bus.stops_) {
+                        pb_bus.add_stops(stop->id);
+                    }
+                    pb_bus.mutable_road_forward()->Add(bus.road_forward_.begin(), bus.road_forward_.end());
+                    pb_bus.mutable_road_backward()->Add(bus.road_backward_.begin(), bus.road_backward_.end());
+                    pb_bus.mutable_geo()->Add(bus.geo_.begin(), bus.geo_.end());
+                    pb_bus.set_bus_type_cycled(bus.bus_type_ == BusType::CYCLED);
+                }
+                writer.Write(field_number, pb_catalogue);
+            }
+
+            const std::vector<uint32_t>& stop_buses_offsets = catalogue_.GetStopBusesOffsets();
+            for (size_t begin = 0; begin < stop_buses_offsets.size(); begin += VALUES_PER_RECORD) {
+                tc_pb::TransportCatalogue pb_catalogue;
+                pb_catalogue.mutable_stop_buses_offsets()->Add(stop_buses_offsets.begin() + begin,
+                    stop_buses_offsets.begin() + std::min(stop_buses_offsets.size(), begin + VALUES_PER_RECORD));
+                writer.Write(field_number, pb_catalogue);
+            }
+            const std::vector<BusPtr>& stop_buses = catalogue_.GetStopBusesFlat();
+            for (size_t begin = 0; begin < stop_buses.size(); begin += VALUES_PER_RECORD) {
+                tc_pb::TransportCatalogue pb_catalogue;
+                for (size_t i = begin; i < std::min(stop_buses.size(), begin + VALUES_PER_RECORD); ++i) {
+                    pb_catalogue.add_stop_buses(stop_buses[i]->id);
+                }
+                writer.Write(field_number, pb_catalogue);
+            }
+
+            tc_pb::TransportCatalogue pb_catalogue;
+            for (const auto& interval_to_distance : catalogue_.GetIntervalsToDistance()) {
+                tc_pb::IntervalToDistance& pb_interval_to_distance = *pb_catalogue.add_intervals_to_distance();
+                pb_interval_to_distance.set_from_id(interval_to_distance.first.first->id);
+                pb_interval_to_distance.set_to_id(interval_to_distance.first.second->id);
+                pb_interval_to_distance.set_distance(static_cast<int64_t>(interval_to_distance.second));
+                if (static_cast<size_t>(pb_catalogue.intervals_to_distance_size()) == VALUES_PER_RECORD) {
+                    writer.Write(field_number, pb_catalogue);
+                    pb_catalogue.Clear();
+                }
+            }
+            if (pb_catalogue.intervals_to_distance_size() != 0) {
+                writer.Write(field_number, pb_catalogue);
+            }
+        }
+
+        void WriteRoutingSettings(SectionWriter& writer) const {
             tc_pb::RoutingSettings pb_routing_settings_;
 
             pb_routing_settings_.set_bus_velocity(routing_settings_.bus_velocity);
             pb_routing_settings_.set_bus_wait_time(routing_settings_.bus_wait_time);
+            pb_routing_settings_.set_algorithm(static_cast<tc_pb::RoutingSettings::RouterAlgorithm>(routing_settings_.algorithm));
+            pb_routing_settings_.set_landmark_count(static_cast<uint32_t>(routing_settings_.landmark_count));
+            pb_routing_settings_.set_hub_labels(routing_settings_.hub_labels);
 
-            *pb_base_.mutable_routing_settings() = std::move(pb_routing_settings_);
+            writer.Write(tc_pb::TransportBase::kRoutingSettingsFieldNumber, pb_routing_settings_);
         }
 
-        void FillRenderSettings() {
+        void WriteRenderSettings(SectionWriter& writer) const {
             tc_pb::RenderSettings pb_render_settings;
             pb_render_settings.set_width(render_settings_.width);
             pb_render_settings.set_height(render_settings_.height);
@@ -184,120 +266,190 @@ namespace Serialize {
                 pb_render_settings.mutable_color_palette()->Add(std::move(pb_color));
             }
 
-            *pb_base_.mutable_rendder_settings() = std::move(pb_render_settings);
-        }
+            pb_render_settings.set_simplify_tolerance(render_settings_.simplify_tolerance);
+            pb_render_settings.mutable_zoom_levels()->Add(render_settings_.zoom_levels.begin(), render_settings_.zoom_levels.end());
 
-        void FillTransportRouter() {
-            tc_pb::TransportRouter pb_transport_router;
-
-            const graph::DirectedWeightedGraph<BusRouteWeight>& g = transport_router_.GetRouteGraph<BusRouteWeight>();
-            for (const auto& edge : g.GetEdges()) {
-                tc_pb::Edge pb_edge;
-                pb_edge.set_vertex_id_from(edge.from);
-                pb_edge.set_vertex_id_to(edge.to);
-
-                tc_pb::BusRouteWeight pb_weight;
-                pb_weight.set_span(edge.weight.span);
-                pb_weight.set_time(edge.weight.time);
-
-                *pb_edge.mutable_weight() = pb_weight;
-
-                pb_transport_router.mutable_route_graph()->mutable_edges()->Add(std::move(pb_edge));
-            }
-
-            for (const std::vector<graph::EdgeId>& incidence_list : g.GetIncidenceLists()) {
-                
-                tc_pb::IncidenceList pb_incidence_list;
+            writer.Write(tc_pb::TransportBase::kRendderSettingsFieldNumber, pb_render_settings);
+        }
 
-                for (graph::EdgeId edge_id : incidence_list) {
-                    pb_incidence_list.add_edge_id(edge_id);
+        // Списки смежности не пишутся: при чтении их восстанавливает AddEdge
+        void WriteTransportRouter(SectionWriter& writer) const {
+            const int field_number = tc_pb::TransportBase::kTransportRouterFieldNumber;
+
+            const std::vector<graph::Edge<BusRouteWeight>>& edges = transport_router_.GetRouteGraph<BusRouteWeight>().GetEdges();
+            const std::vector<uint64_t>& distances = transport_router_.GetEdgeDistances();
+            for (size_t begin = 0; begin < edges.size(); begin += VALUES_PER_RECORD) {
+                tc_pb::TransportRouter pb_transport_router;
+                tc_pb::DirectedWeightedGraph& pb_graph = *pb_transport_router.mutable_route_graph();
+                for (size_t i = begin; i < std::min(edges.size(), begin + VALUES_PER_RECORD); ++i) {
+                    tc_pb::Edge& pb_edge = *pb_graph.add_edges();
+                    pb_edge.set_vertex_id_from(edges[i].from);
+                    pb_edge.set_vertex_id_to(edges[i].to);
+                    pb_edge.mutable_weight()->set_span(edges[i].weight.span);
+                    pb_edge.mutable_weight()->set_time(edges[i].weight.time);
+                    pb_edge.set_distance(distances[i]);
                 }
-
-                pb_transport_router.mutable_route_graph()->mutable_incidence_lists()->Add(std::move(pb_incidence_list));
+                writer.Write(field_number, pb_transport_router);
             }
 
+            tc_pb::TransportRouter pb_transport_router;
             for (StopPtr stop : transport_router_.GetVertexIndexToStop()) {
                 pb_transport_router.add_vertex_index_to_stop(stop->id);
             }
+            writer.Write(field_number, pb_transport_router);
+
+            pb_transport_router.Clear();
             for (BusPtr bus : transport_router_.GetEdgeIndexToBus()) {
+                tc_pb::BusId& pb_bus_id = *pb_transport_router.add_edge_index_to_bus();
                 if (bus) {
-                    tc_pb::BusId pb_bus_id;
                     pb_bus_id.set_bus_id(bus->id);
                     pb_bus_id.set_isinitialized(true);
-                    pb_transport_router.mutable_edge_index_to_bus()->Add(std::move(pb_bus_id));
-
                 }
                 else {
-                    tc_pb::BusId pb_bus_id;
                     pb_bus_id.set_isinitialized(false);
-                    pb_transport_router.mutable_edge_index_to_bus()->Add(std::move(pb_bus_id));
-
                 }
+                if (static_cast<size_t>(pb_transport_router.edge_index_to_bus_size()) == VALUES_PER_RECORD) {
+                    writer.Write(field_number, pb_transport_router);
+                    pb_transport_router.Clear();
+                }
+            }
+            if (pb_transport_router.edge_index_to_bus_size() != 0) {
+                writer.Write(field_number, pb_transport_router);
             }
-            *pb_base_.mutable_transport_router() = std::move(pb_transport_router);
         }
 
-        void FillRouter() {
+        void WriteRouter(SectionWriter& writer) const {
 
             using RouteInternalData = graph::Router<BusRouteWeight>::RouteInternalData;
 
-            tc_pb::Router pb_router;
+            const auto& routes_internal_data = router_.GetRoutesInternalData();
+            const size_t rows_per_record = std::max<size_t>(1, ROUTER_CELLS_PER_RECORD / std::max<size_t>(1, routes_internal_data.size()));
 
-            for (const std::vector<std::optional<RouteInternalData>>& row : router_.GetRoutesInternalData()) {
+            tc_pb::Router pb_router;
+            for (const std::vector<std::optional<RouteInternalData>>& row : routes_internal_data) {
 
-                tc_pb::RouteInternalDataRow pb_row;
+                tc_pb::RouteInternalDataRow& pb_row = *pb_router.add_routes_internal_data();
 
                 for (const std::optional<RouteInternalData>& data : row) {
+                    tc_pb::RouteInternalData& pb_data = *pb_row.add_route_internal_data_row();
                     if (data.has_value()) {
-                        tc_pb::RouteInternalData pb_data;
-
                         pb_data.mutable_weight()->set_span(data->weight.span);
                         pb_data.mutable_weight()->set_time(data->weight.time);
 
                         if (data->prev_edge.has_value()) {
                             pb_data.mutable_prev_edge()->set_prev_edge_id(data->prev_edge.value());
                         }
+                    }
+                }
 
-                        pb_row.mutable_route_internal_data_row()->Add(std::move(pb_data));
+                if (static_cast<size_t>(pb_router.routes_internal_data_size()) == rows_per_record) {
+                    writer.Write(tc_pb::TransportBase::kRouterFieldNumber, pb_router);
+                    pb_router.Clear();
+                }
+            }
+            if (pb_router.routes_internal_data_size() != 0) {
+                writer.Write(tc_pb::TransportBase::kRouterFieldNumber, pb_router);
+            }
+        }
 
+        void WriteTimetable(SectionWriter& writer) const {
+            const int field_number = tc_pb::TransportBase::kTimetableFieldNumber;
+
+            const std::vector<catalogue::Connection>& connections = timetable_.GetConnections();
+            for (size_t begin = 0; begin < connections.size(); begin += VALUES_PER_RECORD) {
+                tc_pb::Timetable pb_timetable;
+                for (size_t i = begin; i < std::min(connections.size(), begin + VALUES_PER_RECORD); ++i) {
+                    const catalogue::Connection& connection = connections[i];
+                    pb_timetable.add_connection_from(connection.from);
+                    pb_timetable.add_connection_to(connection.to);
+                    pb_timetable.add_connection_trip(connection.trip);
+                    pb_timetable.add_connection_position(connection.position);
+                    pb_timetable.add_connection_departure(connection.departure);
+                    pb_timetable.add_connection_arrival(connection.arrival);
+                }
+                writer.Write(field_number, pb_timetable);
+            }
+
+            const std::vector<BusPtr>& trip_buses = timetable_.GetTripBuses();
+            for (size_t begin = 0; begin < trip_buses.size(); begin += VALUES_PER_RECORD) {
+                tc_pb::Timetable pb_timetable;
+                for (size_t i = begin; i < std::min(trip_buses.size(), begin + VALUES_PER_RECORD); ++i) {
+                    pb_timetable.add_trip_buses(trip_buses[i]->id);
+                }
+                writer.Write(field_number, pb_timetable);
+            }
+        }
+
+        void WriteLandmarks(SectionWriter& writer) const {
+            const int field_number = tc_pb::TransportBase::kLandmarksFieldNumber;
+            if (landmarks_.GetLandmarkCount() == 0) {
+                return;
+            }
+
+            tc_pb::Landmarks pb_landmarks;
+            pb_landmarks.set_time_quantum(landmarks_.GetTimeQuantum());
+            pb_landmarks.mutable_landmark_stops()->Add(landmarks_.GetLandmarkStops().begin(), landmarks_.GetLandmarkStops().end());
+            writer.Write(field_number, pb_landmarks);
+
+            auto write_times = [&writer, field_number](const std::vector<uint16_t>& times, bool from_landmarks) {
+                for (size_t begin = 0; begin < times.size(); begin += VALUES_PER_RECORD) {
+                    tc_pb::Landmarks pb_landmarks;
+                    std::string& bytes = from_landmarks ? *pb_landmarks.add_from_landmarks() : *pb_landmarks.add_to_landmarks();
+                    bytes.reserve(2 * VALUES_PER_RECORD);
+                    for (size_t i = begin; i < std::min(times.size(), begin + VALUES_PER_RECORD); ++i) {
+                        bytes.push_back(static_cast<char>(times[i] & 0xFF));
+                        bytes.push_back(static_cast<char>(times[i] >> 8));
                     }
-                    else {
-                        pb_row.add_route_internal_data_row();
-                    }
+                    writer.Write(field_number, pb_landmarks);
                 }
+            };
+            write_times(landmarks_.GetFromLandmarks(), true);
+            write_times(landmarks_.GetToLandmarks(), false);
+        }
 
-                pb_router.mutable_routes_internal_data()->Add(std::move(pb_row));
+        void WriteHubLabels(SectionWriter& writer) const {
+            const int field_number = tc_pb::TransportBase::kHubLabelsFieldNumber;
+            if (hub_labels_.IsEmpty()) {
+                return;
             }
 
-            *pb_base_.mutable_router() = std::move(pb_router);
+            tc_pb::HubLabels pb_offsets;
+            pb_offsets.mutable_out_offsets()->Add(hub_labels_.GetOutOffsets().begin(), hub_labels_.GetOutOffsets().end());
+            pb_offsets.mutable_in_offsets()->Add(hub_labels_.GetInOffsets().begin(), hub_labels_.GetInOffsets().end());
+            writer.Write(field_number, pb_offsets);
+
+            auto write_labels = [&writer, field_number](const std::vector<uint32_t>& hubs, const std::vector<double>& times, bool out) {
+                for (size_t begin = 0; begin < hubs.size(); begin += VALUES_PER_RECORD) {
+                    const size_t end = std::min(hubs.size(), begin + VALUES_PER_RECORD);
+                    tc_pb::HubLabels pb_labels;
+                    (out ? pb_labels.mutable_out_hubs() : pb_labels.mutable_in_hubs())->Add(hubs.begin() + begin, hubs.begin() + end);
+                    (out ? pb_labels.mutable_out_times() : pb_labels.mutable_in_times())->Add(times.begin() + begin, times.begin() + end);
+                    writer.Write(field_number, pb_labels);
+                }
+            };
+            write_labels(hub_labels_.GetOutHubs(), hub_labels_.GetOutTimes(), true);
+            write_labels(hub_labels_.GetInHubs(), hub_labels_.GetInTimes(), false);
         }
 
     };
 
+    // Читает базу по частям: конструктор только находит в файле записи разделов
+    // (или поля верхнего уровня TransportBase в базе старого формата),
+    // а каждый раздел разбирается при вызове соответствующего Get*
     class Deserializer {
     public:
         Deserializer() = delete;
         Deserializer(const std::filesystem::path& p)
             : open_path_(p)
         {
-            std::ifstream input_file(open_path_, std::ios::binary);
-            if (!input_file) {
-                throw std::runtime_error("Can't open file? bad path?");
-            }
-
-            pb_base_.ParseFromIstream(&input_file);
+            IndexSections();
         }
         Deserializer(SerializeSettings settings)
             : open_path_(std::filesystem::path(settings.file))
             , serialize_settings_(settings)
 
         {
-            std::ifstream input_file(open_path_, std::ios::binary);
-            if (!input_file) {
-                throw std::runtime_error("Can't open file? bad path?");
-            }
-
-            pb_base_.ParseFromIstream(&input_file);
+            IndexSections();
         }
 
         catalogue::TransportCatalogue GetTransportCatalogue() const;
@@ -306,12 +458,37 @@ namespace Serialize {
 
         catalogue::TransportRouter GetTransportRouter(const catalogue::TransportCatalogue& catalogue) const;
         graph::Router<BusRouteWeight> GetRouter(const graph::DirectedWeightedGraph<BusRouteWeight>& graph) const;
+        // Пустое расписание, если в базе его нет
+        catalogue::Timetable GetTimetable(const catalogue::TransportCatalogue& catalogue) const;
+        // Пустые ориентиры, если в базе их нет
+        catalogue::Landmarks GetLandmarks() const;
+        // Пустые метки, если в базе их нет
+        catalogue::HubLabels GetHubLabels(const catalogue::TransportCatalogue& catalogue) const;
     private:
-        std::filesystem::path open_path_;
+        // положение значения поля в файле
+        struct Section {
+            std::streamoff offset = 0;
+            // длина сообщения
+            size_t size = 0;
+            // длина данных в файле
+            size_t stored_size = 0;
+            Codec codec = Codec::NONE;
+            std::optional<uint32_t> checksum;
+        };
 
-        tc_pb::TransportBase pb_base_;
+        std::filesystem::path open_path_;
+        // номер поля TransportBase -> его вхождения в порядке следования в файле
+        std::map<int, std::vector<Section>> sections_;
         SerializeSettings serialize_settings_;
 
+        void IndexSections();
+        // Разбирает все вхождения поля field_number; если поля нет, возвращает пустое сообщение
+        template <typename Message>
+        Message ReadSection(int field_number) const;
+        // Значения всех вхождений поля field_number, записанные подряд.
+        // Записи распаковываются и проверяются параллельно
+        std::string ReadSectionBytes(int field_number) const;
+
         static svg::Color ExtractSVGColorFromPBColor(tc_pb::Color pb_color);
     };
 } // namespace Serialize
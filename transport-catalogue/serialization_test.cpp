@@ -0,0 +1,137 @@
+#include "serialization.h"
+#include "transport_catalogue.h"
+#include "transport_catalogue.pb.h"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+    int failures = 0;
+
+    void Check(bool condition, std::string_view what) {
+        if (!condition) {
+            std::cerr << what << std::endl;
+            ++failures;
+        }
+    }
+
+    tc_pb::Stop* AddStop(tc_pb::TransportCatalogue& pb_catalogue, int id, const std::string& name, double lat, double lng) {
+        tc_pb::Stop* stop = pb_catalogue.add_stops();
+        stop->set_id(id);
+        stop->set_name(name);
+        stop->mutable_coordinates()->set_lat(lat);
+        stop->mutable_coordinates()->set_lng(lng);
+        return stop;
+    }
+
+    void AddBus(tc_pb::TransportCatalogue& pb_catalogue, int id, const std::string& name, const std::vector<int>& stops, bool cycled) {
+        tc_pb::Bus* bus = pb_catalogue.add_buses();
+        bus->set_id(id);
+        bus->set_name(name);
+        for (int stop : stops) {
+            bus->add_stops(stop);
+        }
+        bus->set_bus_type_cycled(cycled);
+    }
+
+    void AddDistance(tc_pb::TransportCatalogue& pb_catalogue, int from, int to, int64_t distance) {
+        tc_pb::IntervalToDistance* interval = pb_catalogue.add_intervals_to_distance();
+        interval->set_from_id(from);
+        interval->set_to_id(to);
+        interval->set_distance(distance);
+    }
+
+    // База в формате до разбиения на разделы: один TransportBase без заголовка, имена
+    // в самих остановках и автобусах, автобусы остановок в сообщениях StopToBuses (поле 3),
+    // без накопленных расстояний автобусов
+    void WriteBaselineBase(const std::filesystem::path& path) {
+        tc_pb::TransportCatalogue pb_catalogue;
+        AddStop(pb_catalogue, 0, "Tolstopaltsevo"s, 55.611087, 37.20829);
+        AddStop(pb_catalogue, 1, "Marushkino"s, 55.595884, 37.209755);
+        AddStop(pb_catalogue, 2, "Rasskazovka"s, 55.632761, 37.333324);
+        AddBus(pb_catalogue, 0, "750"s, { 0, 1, 2 }, false);
+        AddBus(pb_catalogue, 1, "256"s, { 2, 0, 2 }, true);
+        // старый make_base сохранял и обратные расстояния, заданные по умолчанию
+        AddDistance(pb_catalogue, 0, 1, 3900);
+        AddDistance(pb_catalogue, 1, 0, 3900);
+        AddDistance(pb_catalogue, 1, 2, 9900);
+        AddDistance(pb_catalogue, 2, 1, 9500);
+        AddDistance(pb_catalogue, 2, 0, 13800);
+        AddDistance(pb_catalogue, 0, 2, 13800);
+
+        // StopToBuses{ stop_id = 1, bus_id = [0] } в поле 3: поле снято из схемы,
+        // поэтому оно дописывается байтами и сохраняется как неизвестное
+        std::string catalogue_bytes = pb_catalogue.SerializeAsString();
+        catalogue_bytes += "\x1A\x05\x08\x01\x12\x01\x00"s;
+
+        tc_pb::TransportBase pb_base;
+        if (!pb_base.mutable_cat()->ParseFromString(catalogue_bytes)) {
+            throw std::runtime_error("Can't build baseline catalogue");
+        }
+        pb_base.mutable_routing_settings()->set_bus_wait_time(6.0);
+        pb_base.mutable_routing_settings()->set_bus_velocity(40.0);
+        pb_base.mutable_rendder_settings()->set_width(1200.0);
+
+        std::ofstream out(path, std::ios::binary);
+        pb_base.SerializeToOstream(&out);
+    }
+
+    std::vector<std::string_view> GetBusNames(const catalogue::TransportCatalogue& cat, std::string_view stop_name) {
+        std::vector<std::string_view> result;
+        for (BusPtr bus : cat.GetStopInfo(stop_name).buses_) {
+            result.push_back(bus->name_);
+        }
+        return result;
+    }
+
+    void TestBaselineBase() {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "transport_catalogue_baseline_base.db";
+        WriteBaselineBase(path);
+
+        const Serialize::Deserializer deserializer(path);
+        const catalogue::TransportCatalogue cat = deserializer.GetTransportCatalogue();
+
+        Check(cat.FindStop("Marushkino"sv) != nullptr, "baseline base: stop names are lost"sv);
+        Check(cat.FindBus("256"sv) != nullptr, "baseline base: bus names are lost"sv);
+        Check(GetBusNames(cat, "Tolstopaltsevo"sv) == std::vector{ "256"sv, "750"sv }, "baseline base: wrong buses of Tolstopaltsevo"sv);
+        Check(GetBusNames(cat, "Marushkino"sv) == std::vector{ "750"sv }, "baseline base: wrong buses of Marushkino"sv);
+
+        const BusInfo ordinary = cat.GetBusInfo("750"sv);
+        Check(ordinary.stops_count == 5 && ordinary.unique_stops_count == 3, "baseline base: wrong stop counts of bus 750"sv);
+        Check(ordinary.route_length == 3900 + 9900 + 9500 + 3900, "baseline base: wrong route length of bus 750"sv);
+        const BusInfo cycled = cat.GetBusInfo("256"sv);
+        Check(cycled.route_length == 13800 + 13800, "baseline base: wrong route length of bus 256"sv);
+        Check(std::isfinite(cycled.curvature) && cycled.curvature > 1.0, "baseline base: wrong curvature of bus 256"sv);
+
+        const catalogue::RoutingSettings routing_settings = deserializer.GetRoutingSettings();
+        Check(routing_settings.bus_wait_time == 6.0 && routing_settings.bus_velocity == 40.0, "baseline base: wrong routing settings"sv);
+
+        std::filesystem::remove(path);
+    }
+
+} // namespace
+
+int main() {
+    try {
+        TestBaselineBase();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        ++failures;
+    }
+
+    if (failures != 0) {
+        std::cerr << failures << " failure(s)"sv << std::endl;
+        return 1;
+    }
+    std::cout << "OK"sv << std::endl;
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "string_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace catalogue {
+
+    std::string_view StringPool::Add(std::string_view str) {
+        if (blocks_.empty() || blocks_.back().capacity - blocks_.back().size < str.size()) {
+            // блоки растут вдвое до BLOCK_SIZE, чтобы маленькие базы не занимали лишнего
+            const size_t next_capacity = blocks_.empty() ? MIN_BLOCK_SIZE : std::min(BLOCK_SIZE, 2 * blocks_.back().capacity);
+            AllocateBlock(std::max({ next_capacity, MIN_BLOCK_SIZE, str.size() }));
+        }
+        Block& block = blocks_.back();
+        char* begin = block.data.get() + block.size;
+        std::memcpy(begin, str.data(), str.size());
+        block.size += str.size();
+        ++strings_count_;
+        return { begin, str.size() };
+    }
+
+    std::string_view StringPool::AddBlob(std::string_view blob, size_t strings_count) {
+        // отдельный блок, чтобы следующие Add не дописывали в его хвост
+        Block& block = AllocateBlock(blob.size());
+        std::memcpy(block.data.get(), blob.data(), blob.size());
+        block.size = blob.size();
+        strings_count_ += strings_count;
+        return { block.data.get(), block.size };
+    }
+
+    StringPool::Block& StringPool::AllocateBlock(size_t capacity) {
+        // без make_unique, чтобы не обнулять память, которая сразу будет перезаписана
+        return blocks_.emplace_back(Block{ std::unique_ptr<char[]>(new char[capacity]), capacity, 0 });
+    }
+
+    memory_stats::ContainerStats StringPool::GetMemoryStats(std::string_view name) const {
+        memory_stats::ContainerStats stats{ std::string(name), strings_count_, memory_stats::HeapBytes(blocks_), std::nullopt };
+        for (const Block& block : blocks_) {
+            stats.heap_bytes += block.capacity;
+        }
+        return stats;
+    }
+
+} // namespace catalogue
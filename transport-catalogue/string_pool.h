@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "memory_stats.h"
+
+namespace catalogue {
+
+    // Хранит строки подряд в крупных блоках. Блоки никогда не перевыделяются,
+    // поэтому string_view на добавленные строки действительны всё время жизни пула,
+    // в том числе после его перемещения
+    class StringPool {
+    public:
+        std::string_view Add(std::string_view str);
+
+        // Копирует blob из strings_count записанных подряд строк в отдельный блок
+        // и возвращает представление на копию. Используется при загрузке из базы
+        std::string_view AddBlob(std::string_view blob, size_t strings_count);
+
+        memory_stats::ContainerStats GetMemoryStats(std::string_view name) const;
+
+    private:
+        static constexpr size_t MIN_BLOCK_SIZE = 256;
+        static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+        struct Block {
+            std::unique_ptr<char[]> data;
+            size_t capacity = 0;
+            size_t size = 0;
+        };
+
+        Block& AllocateBlock(size_t capacity);
+
+        std::vector<Block> blocks_;
+        size_t strings_count_ = 0;
+    };
+
+} // namespace catalogue
@@ -1,5 +1,7 @@
 #include "svg.h"
 
+#include <charconv>
+
 namespace svg {
 
     using namespace std::literals;
@@ -69,6 +71,14 @@ namespace svg {
         context.out << std::endl;
     }
 
+    void Object::Render(Buffer& out, int indent) const {
+        for (int i = 0; i < indent; ++i) {
+            out << ' ';
+        }
+        RenderObject(out);
+        out << '\n';
+    }
+
     // ---------- Circle ------------------
 
     Circle& Circle::SetCenter(Point center) {
@@ -82,11 +92,19 @@ namespace svg {
     }
 
     void Circle::RenderObject(const RenderContext& context) const {
-        auto& out = context.out;
+        RenderTo(context.out);
+    }
+
+    void Circle::RenderObject(Buffer& out) const {
+        RenderTo(out);
+    }
+
+    template <typename Out>
+    void Circle::RenderTo(Out& out) const {
         out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
         out << "r=\""sv << radius_ << "\""sv;
         // Выводим атрибуты, унаследованные от PathProps
-        RenderAttrs(context.out);
+        RenderAttrs(out);
         out << "/>"sv;
     }
 
@@ -98,7 +116,15 @@ namespace svg {
     }
 
     void Polyline::RenderObject(const RenderContext& context) const {
-        auto& out = context.out;
+        RenderTo(context.out);
+    }
+
+    void Polyline::RenderObject(Buffer& out) const {
+        RenderTo(out);
+    }
+
+    template <typename Out>
+    void Polyline::RenderTo(Out& out) const {
         out << "<polyline points=\"";
         bool is_first_point = true;
         for (const Point& point : points_) {
@@ -109,13 +135,21 @@ namespace svg {
             is_first_point = false;
         }
         out << "\"";
-        RenderAttrs(context.out);
+        RenderAttrs(out);
         out << "/>"sv;
     }
 
     // ---------- text ------------------------
     void Text::RenderObject(const RenderContext& context) const {
-        auto& out = context.out;
+        RenderTo(context.out);
+    }
+
+    void Text::RenderObject(Buffer& out) const {
+        RenderTo(out);
+    }
+
+    template <typename Out>
+    void Text::RenderTo(Out& out) const {
         out << "<text x=\""sv << position_.x << "\" y=\""sv << position_.y << "\" "sv;
         out << "dx=\""sv << offset_.x << "\" dy=\""sv << offset_.y << "\""sv;
         out << " font-size=\""sv << size_ << "\""sv;
@@ -125,7 +159,7 @@ namespace svg {
         if (!font_weight_.empty()) {
             out << " font-weight=\""sv << font_weight_ << "\""sv;
         }
-        RenderAttrs(context.out);
+        RenderAttrs(out);
         out << ">"sv << data_ << "</text>"sv;
     }
 
@@ -209,6 +243,21 @@ namespace svg {
         objects_.emplace_back(std::move(obj));
     }
 
+    size_t Document::GetObjectsCount() const {
+        return objects_.size();
+    }
+
+    void Document::Render(Buffer& out) const {
+        // типичный тег карты занимает около сотни символов
+        out.Reserve(out.GetSize() + 128 * (objects_.size() + 1));
+        out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv;
+        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv;
+        for (const auto& object : objects_) {
+            object->Render(out, 2);
+        }
+        out << "</svg>"sv;
+    }
+
     void Document::Render(std::ostream& out) const {
         out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl;
         out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
@@ -241,4 +290,84 @@ namespace svg {
         return out;
     }
 
-}  // namespace svg
\ No newline at end of file
+    // ------------ Buffer ----------
+
+    Buffer& Buffer::operator<<(double value) {
+        // как у std::ostream по умолчанию: формат %g с точностью 6
+        char chars[32];
+        const auto result = std::to_chars(std::begin(chars), std::end(chars), value, std::chars_format::general, 6);
+        data_.append(chars, result.ptr);
+        return *this;
+    }
+
+    Buffer& Buffer::operator<<(int value) {
+        char chars[16];
+        const auto result = std::to_chars(std::begin(chars), std::end(chars), value);
+        data_.append(chars, result.ptr);
+        return *this;
+    }
+
+    Buffer& Buffer::operator<<(uint32_t value) {
+        char chars[16];
+        const auto result = std::to_chars(std::begin(chars), std::end(chars), value);
+        data_.append(chars, result.ptr);
+        return *this;
+    }
+
+    Buffer& operator<<(Buffer& out, const Point& point) {
+        return out << point.x << ',' << point.y;
+    }
+
+    Buffer& operator<<(Buffer& out, const Color& color) {
+        if (const auto* str = std::get_if<std::string>(&color)) {
+            return out << *str;
+        }
+        if (const auto* rgb = std::get_if<Rgb>(&color)) {
+            return out << "rgb("sv << +rgb->red << ',' << +rgb->green << ',' << +rgb->blue << ')';
+        }
+        if (const auto* rgba = std::get_if<Rgba>(&color)) {
+            return out << "rgba("sv << +rgba->red << ',' << +rgba->green << ',' << +rgba->blue << ','
+                << rgba->opacity << ')';
+        }
+        return out << "none"sv;
+    }
+
+    Buffer& operator<<(Buffer& out, StrokeLineCap linecap) {
+        switch (linecap)
+        {
+        case StrokeLineCap::BUTT:
+            return out << "butt"sv;
+        case StrokeLineCap::ROUND:
+            return out << "round"sv;
+        case StrokeLineCap::SQUARE:
+            return out << "square"sv;
+        default:
+            return out;
+        }
+    }
+
+    Buffer& operator<<(Buffer& out, StrokeLineJoin linejoin) {
+        switch (linejoin)
+        {
+        case StrokeLineJoin::ARCS:
+            return out << "arcs"sv;
+        case StrokeLineJoin::BEVEL:
+            return out << "bevel"sv;
+        case StrokeLineJoin::MITER:
+            return out << "miter"sv;
+        case StrokeLineJoin::MITER_CLIP:
+            return out << "miter-clip"sv;
+        case StrokeLineJoin::ROUND:
+            return out << "round"sv;
+        default:
+            return out;
+        }
+    }
+
+    Color PreformatColor(const Color& color) {
+        Buffer out;
+        out << color;
+        return out.Release();
+    }
+
+}  // namespace svg
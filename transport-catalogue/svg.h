@@ -7,6 +7,7 @@
 #include <vector>
 #include <algorithm>
 #include <optional>
+#include <string_view>
 #include <variant>
 #include <math.h>
 
@@ -86,6 +87,63 @@ namespace svg {
     std::ostream& operator<<(std::ostream& out, StrokeLineCap linecap);
     std::ostream& operator<<(std::ostream& out, StrokeLineJoin linejoin);
 
+    /*
+     * Растущий буфер символов для вывода документа без std::ostream.
+     * Числа форматируются через std::to_chars так же, как поток с настройками по умолчанию
+     */
+    class Buffer {
+    public:
+        Buffer() = default;
+        explicit Buffer(size_t capacity) {
+            data_.reserve(capacity);
+        }
+
+        Buffer& operator<<(std::string_view str) {
+            data_.append(str);
+            return *this;
+        }
+        // строки выводятся как есть, а не через неявное преобразование в svg::Color
+        Buffer& operator<<(const std::string& str) {
+            data_.append(str);
+            return *this;
+        }
+        Buffer& operator<<(const char* str) {
+            data_.append(str);
+            return *this;
+        }
+        Buffer& operator<<(char c) {
+            data_.push_back(c);
+            return *this;
+        }
+        void Reserve(size_t capacity) {
+            data_.reserve(capacity);
+        }
+
+        Buffer& operator<<(double value);
+        Buffer& operator<<(int value);
+        Buffer& operator<<(uint32_t value);
+
+        size_t GetSize() const {
+            return data_.size();
+        }
+
+        // Отдаёт накопленный текст без копирования, буфер остаётся пустым
+        std::string Release() {
+            return std::move(data_);
+        }
+
+    private:
+        std::string data_;
+    };
+
+    Buffer& operator<<(Buffer& out, const Point& point);
+    Buffer& operator<<(Buffer& out, const Color& color);
+    Buffer& operator<<(Buffer& out, StrokeLineCap linecap);
+    Buffer& operator<<(Buffer& out, StrokeLineJoin linejoin);
+
+    // Возвращает цвет в виде готовой строки, чтобы не форматировать его при каждом выводе
+    Color PreformatColor(const Color& color);
+
     /*
      * Вспомогательная структура, хранящая контекст для вывода SVG-документа с отступами.
      * Хранит ссылку на поток вывода, текущее значение и шаг отступа при выводе элемента
@@ -141,7 +199,8 @@ namespace svg {
             return AsOwner();
         }
 
-        virtual void RenderAttrs(const RenderContext& context) const;
+        template <typename Out>
+        void RenderAttrs(Out& out) const;
 
     private:
         Owner& AsOwner() {
@@ -165,11 +224,14 @@ namespace svg {
     class Object {
     public:
         void Render(const RenderContext& context) const;
+        // Выводит тег в буфер с отступом indent и переводом строки
+        void Render(Buffer& out, int indent) const;
 
         virtual ~Object() = default;
 
     private:
         virtual void RenderObject(const RenderContext& context) const = 0;
+        virtual void RenderObject(Buffer& out) const = 0;
     };
 
     /*
@@ -186,6 +248,9 @@ namespace svg {
 
     private:
         void RenderObject(const RenderContext& context) const override;
+        void RenderObject(Buffer& out) const override;
+        template <typename Out>
+        void RenderTo(Out& out) const;
 
         Point center_;
         double radius_ = 1.0;
@@ -205,6 +270,9 @@ namespace svg {
         std::vector<Point> points_;
 
         void RenderObject(const RenderContext& context) const override;
+        void RenderObject(Buffer& out) const override;
+        template <typename Out>
+        void RenderTo(Out& out) const;
     };
 
     /*
@@ -242,6 +310,9 @@ namespace svg {
         std::string font_weight_;
         std::string data_;
         void RenderObject(const RenderContext& context) const override;
+        void RenderObject(Buffer& out) const override;
+        template <typename Out>
+        void RenderTo(Out& out) const;
         std::string TransformText(std::string text);
     };
 
@@ -285,6 +356,10 @@ namespace svg {
 
         // Выводит в ostream svg-представление документа
         void Render(std::ostream& out) const;
+        // Выводит svg-представление документа в буфер
+        void Render(Buffer& out) const;
+
+        size_t GetObjectsCount() const;
 
     private:
         std::vector<std::unique_ptr<Object>> objects_;
@@ -299,8 +374,8 @@ namespace svg {
     //----------- PathProps --------------
 
     template <typename Owner>
-    void PathProps<Owner>::RenderAttrs(const RenderContext& context) const {
-        auto& out = context.out;
+    template <typename Out>
+    void PathProps<Owner>::RenderAttrs(Out& out) const {
         if (fill_color_.has_value()) {
             out << " fill=\"" << fill_color_.value() << "\"";
         }
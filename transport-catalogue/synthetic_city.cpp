@@ -0,0 +1,291 @@
+#include "synthetic_city.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "geo.h"
+
+using namespace std::literals;
+
+namespace synthetic {
+
+    namespace {
+
+        // std::*_distribution зависят от реализации стандартной библиотеки,
+        // поэтому числа берутся напрямую из mt19937, поведение которого фиксировано стандартом
+        class Random {
+        public:
+            explicit Random(uint32_t seed)
+                : engine_(seed) {
+            }
+
+            size_t Index(size_t bound) {
+                return static_cast<size_t>(engine_() % bound);
+            }
+
+            double Uniform(double from, double to) {
+                return from + (to - from) * (static_cast<double>(engine_()) / std::mt19937::max());
+            }
+
+            bool Chance(double probability) {
+                return Uniform(0.0, 1.0) < probability;
+            }
+
+        private:
+            std::mt19937 engine_;
+        };
+
+        // Остановки расположены на сетке side x side со случайным сдвигом,
+        // маршруты идут по соседним узлам сетки
+        class Grid {
+        public:
+            explicit Grid(size_t stop_count)
+                : stop_count_(stop_count)
+                , side_(std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(stop_count)))))) {
+            }
+
+            std::vector<size_t> GetNeighbours(size_t index) const {
+                std::vector<size_t> result;
+                const size_t row = index / side_;
+                const size_t column = index % side_;
+                if (column > 0) {
+                    result.push_back(index - 1);
+                }
+                if (column + 1 < side_ && index + 1 < stop_count_) {
+                    result.push_back(index + 1);
+                }
+                if (row > 0) {
+                    result.push_back(index - side_);
+                }
+                if (index + side_ < stop_count_) {
+                    result.push_back(index + side_);
+                }
+                return result;
+            }
+
+            geo::Coordinates GetCoordinates(size_t index, Random& random) const {
+                static const double lat_begin = 55.5, lat_end = 55.9;
+                static const double lng_begin = 37.3, lng_end = 37.9;
+                const double cell_lat = (lat_end - lat_begin) / side_;
+                const double cell_lng = (lng_end - lng_begin) / side_;
+                return {
+                    lat_begin + cell_lat * (index / side_ + random.Uniform(0.1, 0.9)),
+                    lng_begin + cell_lng * (index % side_ + random.Uniform(0.1, 0.9))
+                };
+            }
+
+        private:
+            size_t stop_count_;
+            size_t side_;
+        };
+
+        // Выбирает индексы из [0, size) по закону Ципфа. Ранги популярности
+        // перемешаны, чтобы популярные остановки не оказались в одном углу сетки
+        class ZipfSampler {
+        public:
+            ZipfSampler(size_t size, double exponent, Random& random)
+                : ranks_(size) {
+                for (size_t index = 0; index < size; ++index) {
+                    ranks_[index] = index;
+                }
+                for (size_t index = size; index > 1; --index) {
+                    std::swap(ranks_[index - 1], ranks_[random.Index(index)]);
+                }
+
+                cumulative_.reserve(size);
+                double sum = 0.0;
+                for (size_t rank = 0; rank < size; ++rank) {
+                    sum += 1.0 / std::pow(static_cast<double>(rank + 1), exponent);
+                    cumulative_.push_back(sum);
+                }
+            }
+
+            size_t operator()(Random& random) const {
+                const double value = random.Uniform(0.0, cumulative_.back());
+                const size_t rank = std::lower_bound(cumulative_.begin(), cumulative_.end(), value) - cumulative_.begin();
+                return ranks_[std::min(rank, ranks_.size() - 1)];
+            }
+
+        private:
+            std::vector<size_t> ranks_;
+            std::vector<double> cumulative_;
+        };
+
+        json::Node MakeRenderSettings() {
+            json::Dict settings;
+            settings.emplace("width", 1200.0);
+            settings.emplace("height", 1200.0);
+            settings.emplace("padding", 50.0);
+            settings.emplace("stop_radius", 5.0);
+            settings.emplace("line_width", 14.0);
+            settings.emplace("bus_label_font_size", 20);
+            settings.emplace("bus_label_offset", json::Array{ 7.0, 15.0 });
+            settings.emplace("stop_label_font_size", 18);
+            settings.emplace("stop_label_offset", json::Array{ 7.0, -3.0 });
+            settings.emplace("underlayer_color", json::Array{ 255, 255, 255, 0.85 });
+            settings.emplace("underlayer_width", 3.0);
+            settings.emplace("color_palette", json::Array{ "green"s, json::Array{ 255, 160, 0 }, "red"s });
+            return settings;
+        }
+
+        json::Node MakeRoutingSettings() {
+            json::Dict settings;
+            settings.emplace("bus_wait_time", 6);
+            settings.emplace("bus_velocity", 40);
+            return settings;
+        }
+
+    } // namespace
+
+    std::string GetStopName(size_t index) {
+        return "Stop "s + std::to_string(index);
+    }
+
+    std::string GetBusName(size_t index) {
+        return "Bus "s + std::to_string(index);
+    }
+
+    json::Document GenerateBase(const CityParams& params) {
+        Random random(params.seed);
+        const Grid grid(params.stop_count);
+
+        std::vector<geo::Coordinates> coordinates;
+        coordinates.reserve(params.stop_count);
+        for (size_t index = 0; index < params.stop_count; ++index) {
+            coordinates.push_back(grid.GetCoordinates(index, random));
+        }
+
+        std::vector<std::map<size_t, int>> distances(params.stop_count);
+        auto declare_distance = [&](size_t from, size_t to) {
+            if (distances[from].count(to) == 0) {
+                const double geo_distance = geo::ComputeDistance(coordinates[from], coordinates[to]);
+                distances[from][to] = static_cast<int>(geo_distance * random.Uniform(1.1, 1.5)) + 1;
+            }
+        };
+
+        for (size_t index = 0; index < params.stop_count; ++index) {
+            for (size_t neighbour : grid.GetNeighbours(index)) {
+                if (random.Chance(params.distance_density)) {
+                    declare_distance(index, neighbour);
+                }
+            }
+        }
+
+        json::Array base_requests;
+        base_requests.reserve(params.stop_count + params.bus_count);
+
+        std::vector<json::Node> bus_requests;
+        bus_requests.reserve(params.bus_count);
+        for (size_t bus_index = 0; bus_index < params.bus_count && params.stop_count > 1; ++bus_index) {
+            const bool is_roundtrip = random.Chance(params.roundtrip_ratio);
+
+            std::vector<size_t> route{ random.Index(params.stop_count) };
+            while (route.size() < std::max<size_t>(2, params.route_length)) {
+                const std::vector<size_t> neighbours = grid.GetNeighbours(route.back());
+                size_t next = neighbours[random.Index(neighbours.size())];
+                // не возвращаемся сразу на предыдущую остановку, если есть выбор
+                if (route.size() > 1 && next == route[route.size() - 2] && neighbours.size() > 1) {
+                    next = neighbours[(std::find(neighbours.begin(), neighbours.end(), next) - neighbours.begin() + 1) % neighbours.size()];
+                }
+                route.push_back(next);
+            }
+            if (is_roundtrip) {
+                route.push_back(route.front());
+            }
+
+            json::Array stops;
+            stops.reserve(route.size());
+            for (size_t i = 0; i < route.size(); ++i) {
+                if (i > 0) {
+                    declare_distance(route[i - 1], route[i]);
+                    if (!is_roundtrip) {
+                        declare_distance(route[i], route[i - 1]);
+                    }
+                }
+                stops.push_back(GetStopName(route[i]));
+            }
+
+            json::Dict bus;
+            bus.emplace("type", "Bus"s);
+            bus.emplace("name", GetBusName(bus_index));
+            bus.emplace("stops", std::move(stops));
+            bus.emplace("is_roundtrip", is_roundtrip);
+            bus_requests.push_back(std::move(bus));
+        }
+
+        for (size_t index = 0; index < params.stop_count; ++index) {
+            json::Dict road_distances;
+            for (const auto& [to, distance] : distances[index]) {
+                road_distances.emplace(GetStopName(to), distance);
+            }
+
+            json::Dict stop;
+            stop.emplace("type", "Stop"s);
+            stop.emplace("name", GetStopName(index));
+            stop.emplace("latitude", coordinates[index].lat);
+            stop.emplace("longitude", coordinates[index].lng);
+            stop.emplace("road_distances", std::move(road_distances));
+            base_requests.push_back(std::move(stop));
+        }
+        for (json::Node& bus : bus_requests) {
+            base_requests.push_back(std::move(bus));
+        }
+
+        json::Dict serialization_settings;
+        serialization_settings.emplace("file", params.serialization_file);
+
+        json::Dict root;
+        root.emplace("serialization_settings", std::move(serialization_settings));
+        root.emplace("routing_settings", MakeRoutingSettings());
+        root.emplace("render_settings", MakeRenderSettings());
+        root.emplace("base_requests", std::move(base_requests));
+        return json::Document{ std::move(root) };
+    }
+
+    json::Document GenerateStatRequests(const CityParams& city, const StatRequestsParams& params) {
+        Random random(params.seed);
+        const ZipfSampler stop_sampler(std::max<size_t>(1, city.stop_count), params.zipf_exponent, random);
+        const ZipfSampler bus_sampler(std::max<size_t>(1, city.bus_count), params.zipf_exponent, random);
+
+        const RequestMix& mix = params.mix;
+        const double total_weight = mix.bus + mix.stop + mix.route + mix.map;
+
+        json::Array stat_requests;
+        stat_requests.reserve(params.request_count);
+        for (size_t id = 1; id <= params.request_count; ++id) {
+            json::Dict request;
+            request.emplace("id", static_cast<int>(id));
+
+            const double choice = random.Uniform(0.0, total_weight);
+            if (choice < mix.bus) {
+                request.emplace("type", "Bus"s);
+                request.emplace("name", GetBusName(bus_sampler(random)));
+            }
+            else if (choice < mix.bus + mix.stop) {
+                request.emplace("type", "Stop"s);
+                request.emplace("name", GetStopName(stop_sampler(random)));
+            }
+            else if (choice < mix.bus + mix.stop + mix.route) {
+                request.emplace("type", "Route"s);
+                request.emplace("from", GetStopName(stop_sampler(random)));
+                request.emplace("to", GetStopName(stop_sampler(random)));
+            }
+            else {
+                request.emplace("type", "Map"s);
+            }
+            stat_requests.push_back(std::move(request));
+        }
+
+        json::Dict serialization_settings;
+        serialization_settings.emplace("file", city.serialization_file);
+
+        json::Dict root;
+        root.emplace("serialization_settings", std::move(serialization_settings));
+        root.emplace("stat_requests", std::move(stat_requests));
+        return json::Document{ std::move(root) };
+    }
+
+} // namespace synthetic
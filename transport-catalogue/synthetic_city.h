@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "json.h"
+
+namespace synthetic {
+
+    // Параметры синтетического города. Генерация детерминирована:
+    // одинаковые параметры всегда дают одинаковый набор запросов
+    struct CityParams {
+        size_t stop_count = 1000;
+        size_t bus_count = 100;
+        // количество остановок в маршруте (до разворота для некольцевых)
+        size_t route_length = 20;
+        // доля кольцевых маршрутов, от 0 до 1
+        double roundtrip_ratio = 0.5;
+        // доля соседних по сетке остановок, для которых явно задано
+        // дорожное расстояние (участки маршрутов задаются всегда), от 0 до 1
+        double distance_density = 0.5;
+        uint32_t seed = 42;
+        std::string serialization_file = "transport_catalogue.db";
+    };
+
+    // Относительные веса типов запросов в пакете stat_requests
+    struct RequestMix {
+        double bus = 40.0;
+        double stop = 30.0;
+        double route = 29.0;
+        double map = 1.0;
+    };
+
+    struct StatRequestsParams {
+        size_t request_count = 10000;
+        RequestMix mix;
+        // показатель распределения Ципфа для выбора остановок и автобусов:
+        // 0 - равномерно, чем больше, тем сильнее запросы концентрируются на популярных
+        double zipf_exponent = 1.0;
+        uint32_t seed = 7;
+    };
+
+    // Строит документ для make_base: base_requests, routing_settings,
+    // render_settings и serialization_settings
+    json::Document GenerateBase(const CityParams& params);
+
+    // Строит документ для process_requests к базе, сгенерированной GenerateBase(city)
+    json::Document GenerateStatRequests(const CityParams& city, const StatRequestsParams& params);
+
+    std::string GetStopName(size_t index);
+    std::string GetBusName(size_t index);
+
+} // namespace synthetic
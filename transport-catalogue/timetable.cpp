@@ -0,0 +1,143 @@
+#include "timetable.h"
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
+namespace catalogue {
+
+    void Timetable::AddBusTrips(BusPtr bus, const std::vector<double>& departures, double bus_velocity) {
+        const size_t stops_count = bus->stops_.size();
+        if (stops_count < 2) {
+            return;
+        }
+        const bool has_backward = bus->bus_type_ == BusType::ORDINARY;
+        // время в пути от начала рейса до каждой его остановки
+        std::vector<double> offsets;
+        offsets.reserve(has_backward ? 2 * stops_count - 1 : stops_count);
+        for (size_t i = 0; i < stops_count; ++i) {
+            offsets.push_back(static_cast<double>(bus->road_forward_[i]) / bus_velocity);
+        }
+        if (has_backward) {
+            const uint64_t forward_length = bus->road_forward_.back();
+            const std::vector<uint64_t>& backward = bus->road_backward_;
+            for (size_t i = stops_count - 1; i-- > 0;) {
+                offsets.push_back(static_cast<double>(forward_length + backward[stops_count - 1] - backward[i]) / bus_velocity);
+            }
+        }
+        auto stop_at = [bus, stops_count](size_t position) {
+            return position < stops_count ? bus->stops_[position] : bus->stops_[2 * stops_count - 2 - position];
+        };
+
+        connections_.reserve(connections_.size() + departures.size() * (offsets.size() - 1));
+        for (const double departure : departures) {
+            const uint32_t trip = static_cast<uint32_t>(trip_buses_.size());
+            trip_buses_.push_back(bus);
+            for (size_t position = 0; position + 1 < offsets.size(); ++position) {
+                connections_.push_back({
+                    static_cast<uint32_t>(stop_at(position)->id),
+                    static_cast<uint32_t>(stop_at(position + 1)->id),
+                    trip,
+                    static_cast<uint32_t>(position),
+                    departure + offsets[position],
+                    departure + offsets[position + 1]
+                    });
+            }
+        }
+    }
+
+    void Timetable::SortConnections() {
+        // при равном отправлении первым идёт перегон с более ранним прибытием; устойчивая
+        // сортировка сохраняет порядок перегонов рейса с нулевым временем в пути
+        std::stable_sort(connections_.begin(), connections_.end(), [](const Connection& lhs, const Connection& rhs) {
+            return std::tie(lhs.departure, lhs.arrival) < std::tie(rhs.departure, rhs.arrival);
+            });
+    }
+
+    bool Timetable::IsEmpty() const {
+        return connections_.empty();
+    }
+
+    const std::vector<Connection>& Timetable::GetConnections() const {
+        return connections_;
+    }
+
+    const std::vector<BusPtr>& Timetable::GetTripBuses() const {
+        return trip_buses_;
+    }
+
+    memory_stats::Report Timetable::GetMemoryStats() const {
+        return {
+            memory_stats::Collect("connections_", connections_),
+            memory_stats::Collect("trip_buses_", trip_buses_)
+        };
+    }
+
+    void Timetable::SetConnections(std::vector<Connection>&& connections, std::vector<BusPtr>&& trip_buses) {
+        connections_ = std::move(connections);
+        trip_buses_ = std::move(trip_buses);
+    }
+
+    ConnectionScanner::ConnectionScanner(const Timetable& timetable, const TransportCatalogue& cat)
+        : timetable_(timetable)
+        , cat_(cat) {
+    }
+
+    std::optional<double> ConnectionScanner::FindEarliestArrival(StopPtr stop_from, StopPtr stop_to, double departure_time,
+        std::vector<ScheduledLeg>& legs) {
+        legs.clear();
+        if (stop_from == stop_to) {
+            return departure_time;
+        }
+
+        const std::vector<Connection>& connections = timetable_.GetConnections();
+        const size_t stop_count = cat_.GetStops().size();
+        earliest_arrival_.assign(stop_count, std::numeric_limits<double>::infinity());
+        arrival_legs_.assign(stop_count, { NO_CONNECTION, NO_CONNECTION });
+        trip_boarding_.assign(timetable_.GetTripBuses().size(), NO_CONNECTION);
+
+        const uint32_t from = static_cast<uint32_t>(stop_from->id);
+        const uint32_t to = static_cast<uint32_t>(stop_to->id);
+        earliest_arrival_[from] = departure_time;
+
+        const auto first = std::lower_bound(connections.begin(), connections.end(), departure_time,
+            [](const Connection& connection, double time) { return connection.departure < time; });
+        for (auto it = first; it != connections.end(); ++it) {
+            const Connection& connection = *it;
+            // следующие перегоны отправляются не раньше, чем уже найденное прибытие
+            if (connection.departure >= earliest_arrival_[to]) {
+                break;
+            }
+            uint32_t& boarding = trip_boarding_[connection.trip];
+            if (boarding == NO_CONNECTION) {
+                if (earliest_arrival_[connection.from] > connection.departure) {
+                    continue;
+                }
+                boarding = static_cast<uint32_t>(it - connections.begin());
+            }
+            if (connection.arrival < earliest_arrival_[connection.to]) {
+                earliest_arrival_[connection.to] = connection.arrival;
+                arrival_legs_[connection.to] = { boarding, static_cast<uint32_t>(it - connections.begin()) };
+            }
+        }
+
+        if (arrival_legs_[to].first == NO_CONNECTION) {
+            return std::nullopt;
+        }
+        for (uint32_t stop = to; stop != from;) {
+            const Connection& boarding = connections[arrival_legs_[stop].first];
+            const Connection& alighting = connections[arrival_legs_[stop].second];
+            legs.push_back({
+                timetable_.GetTripBuses()[boarding.trip],
+                &cat_.GetStops()[boarding.from],
+                boarding.departure,
+                alighting.arrival,
+                static_cast<int>(alighting.position - boarding.position + 1)
+                });
+            stop = boarding.from;
+        }
+        std::reverse(legs.begin(), legs.end());
+        return earliest_arrival_[to];
+    }
+
+} // namespace catalogue
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "domain.h"
+#include "memory_stats.h"
+#include "transport_catalogue.h"
+
+namespace catalogue {
+
+    // Отправления рейсов автобуса: времена отправления от первой остановки в минутах от начала суток.
+    // Имя должно быть действительно во время вызова Timetable::AddBusTrips
+    struct BusTripsDescription {
+        std::string_view bus_name;
+        std::vector<double> departures;
+    };
+
+    // Перегон рейса между соседними остановками
+    struct Connection {
+        // id остановок
+        uint32_t from = 0;
+        uint32_t to = 0;
+        // индекс рейса в Timetable::GetTripBuses()
+        uint32_t trip = 0;
+        // номер перегона от начала рейса
+        uint32_t position = 0;
+        double departure = 0.0;
+        double arrival = 0.0;
+    };
+
+    // Расписание: все перегоны всех рейсов в одном массиве по возрастанию времени отправления
+    class Timetable {
+    public:
+        // Рейс идёт по остановкам автобуса со скоростью bus_velocity (м/мин) без стоянок;
+        // рейс некольцевого автобуса, дойдя до конечной, возвращается к первой остановке
+        void AddBusTrips(BusPtr bus, const std::vector<double>& departures, double bus_velocity);
+        // Упорядочивает перегоны по отправлению, вызывается после всех AddBusTrips
+        void SortConnections();
+
+        bool IsEmpty() const;
+        const std::vector<Connection>& GetConnections() const;
+        const std::vector<BusPtr>& GetTripBuses() const;
+
+        // Оценка занимаемой памяти
+        memory_stats::Report GetMemoryStats() const;
+
+        // serialization: connections уже упорядочены
+        void SetConnections(std::vector<Connection>&& connections, std::vector<BusPtr>&& trip_buses);
+
+    private:
+        std::vector<Connection> connections_;
+        // автобус каждого рейса
+        std::vector<BusPtr> trip_buses_;
+    };
+
+    // Участок маршрута по расписанию: поездка одним рейсом
+    struct ScheduledLeg {
+        BusPtr bus = nullptr;
+        StopPtr from = nullptr;
+        double departure = 0.0;
+        double arrival = 0.0;
+        int span_count = 0;
+    };
+
+    // Поиск самого раннего прибытия алгоритмом Connection Scan: один проход
+    // по перегонам расписания, начиная с первого отправления не раньше заданного.
+    // Пересадка возможна, если к отправлению рейса пассажир уже на остановке
+    class ConnectionScanner {
+    public:
+        ConnectionScanner(const Timetable& timetable, const TransportCatalogue& cat);
+
+        // Записывает участки маршрута в legs (буфер переиспользуется между запросами)
+        // и возвращает время прибытия в stop_to или nullopt, если доехать нельзя
+        std::optional<double> FindEarliestArrival(StopPtr stop_from, StopPtr stop_to, double departure_time,
+            std::vector<ScheduledLeg>& legs);
+
+    private:
+        static constexpr uint32_t NO_CONNECTION = UINT32_MAX;
+
+        const Timetable& timetable_;
+        const TransportCatalogue& cat_;
+
+        // состояние поиска, выделяется один раз
+        std::vector<double> earliest_arrival_;
+        // для остановки - перегоны посадки и высадки рейса, которым в неё приехали
+        std::vector<std::pair<uint32_t, uint32_t>> arrival_legs_;
+        // для рейса - перегон, на котором в него сели
+        std::vector<uint32_t> trip_boarding_;
+    };
+
+} // namespace catalogue
@@ -1,66 +1,177 @@
 #include "transport_catalogue.h"
 
+#include <stdexcept>
+
 namespace catalogue {
-    void TransportCatalogue::AddBus(std::string_view name, const std::vector<std::string>& stops, BusType type) {
+    namespace {
+        // Вставляет элементы в индекс по имени. После сортировки каждая вставка
+        // в конец индекса с подсказкой выполняется за амортизированное O(1).
+        // Устойчивая сортировка оставляет в индексе последний из одноимённых элементов,
+        // как при поэлементном добавлении
+        template <typename Ptr>
+        void AddToIndex(std::map<std::string_view, Ptr>& index, std::vector<Ptr> items) {
+            std::stable_sort(items.begin(), items.end(), [](Ptr lhs, Ptr rhs) {
+                return lhs->name_ < rhs->name_;
+                });
+            for (Ptr item : items) {
+                index.insert_or_assign(index.end(), item->name_, item);
+            }
+        }
+    } // namespace
+
+    void TransportCatalogue::AddBulk(const std::vector<StopDescription>& stops, const std::vector<BusDescription>& buses) {
+        std::unordered_map<std::string_view, StopPtr> stop_by_name;
+        stop_by_name.reserve(stops_.size() + stops.size());
+        for (const Stop& stop : stops_) {
+            stop_by_name[stop.name_] = &stop;
+        }
+        auto find_stop = [&stop_by_name](std::string_view name) -> StopPtr {
+            const auto it = stop_by_name.find(name);
+            return it == stop_by_name.end() ? nullptr : it->second;
+        };
+
+        std::vector<StopPtr> new_stops;
+        new_stops.reserve(stops.size());
+        size_t distances_count = 0;
+        for (const StopDescription& description : stops) {
+            const Stop& stop = stops_.emplace_back(Stop{ names_.Add(description.name), description.coordinates, stop_count_++ });
+            stop_by_name[stop.name_] = &stop;
+            new_stops.push_back(&stop);
+            distances_count += description.road_distances.size();
+        }
+        AddToIndex(index_stops_, new_stops);
+
+        distance_between_stops_.reserve(distance_between_stops_.size() + 2 * distances_count);
+        for (size_t i = 0; i < stops.size(); ++i) {
+            for (const auto& [name_to, distance] : stops[i].road_distances) {
+                if (StopPtr stop_to = find_stop(name_to)) {
+                    SetDistance({ new_stops[i], stop_to }, distance);
+                }
+            }
+        }
+
+        std::vector<BusPtr> new_buses;
+        new_buses.reserve(buses.size());
+        for (const BusDescription& description : buses) {
+            Bus& bus = buses_.emplace_back(Bus{ names_.Add(description.name), {}, description.type, bus_count_++, {}, {}, {} });
+            bus.stops_.reserve(description.stops.size());
+            for (std::string_view stop_name : description.stops) {
+                if (StopPtr stop = find_stop(stop_name)) {
+                    bus.stops_.push_back(stop);
+                }
+            }
+            FillBusDistances(bus);
+            new_buses.push_back(&bus);
+        }
+        AddToIndex(index_buses_, new_buses);
+
+        BuildStopBuses();
+    }
+
+    void TransportCatalogue::AddBus(std::string_view name, const std::vector<std::string_view>& stops, BusType type) {
         std::vector<StopPtr> stops_ptr;
-        auto it = buses_.insert(buses_.end(), std::move(Bus{ std::string(name), stops_ptr, type, bus_count_++ }));
+        auto it = buses_.insert(buses_.end(), Bus{ names_.Add(name), stops_ptr, type, bus_count_++, {}, {}, {} });
 
         for_each(stops.begin(), stops.end(), [&stops_ptr, &it, this](std::string_view stop_name) {
             if (StopPtr stop_ptr = FindStop(stop_name)) {
                 it->stops_.push_back(std::move(stop_ptr));
-                buses_for_stops_[stop_ptr].insert(&*it);
             }
 
             });
+        FillBusDistances(*it);
         index_buses_[std::string_view{ it->name_ }] = &(*it);
+        stop_buses_outdated_ = true;
     }
 
     void TransportCatalogue::AddStop(std::string_view name, geo::Coordinates coordinates) {
-        auto it = stops_.emplace(stops_.end(), std::move(Stop{ std::string(name), coordinates, stop_count_++ }));
+        auto it = stops_.emplace(stops_.end(), std::move(Stop{ names_.Add(name), coordinates, stop_count_++ }));
         index_stops_[std::string_view{ it->name_ }] = &(*it);
+        // у новой остановки ещё нет автобусов
+        if (stop_buses_offsets_.empty()) {
+            stop_buses_offsets_.push_back(0);
+        }
+        stop_buses_offsets_.push_back(stop_buses_offsets_.back());
     }
 
-    StopPtr TransportCatalogue::FindStop(std::string_view name) const {
-        if (index_stops_.count(name) == 0) {
-            return nullptr;
+    void TransportCatalogue::BuildStopBuses() {
+        // сортировка подсчётом пар (остановка, автобус) по id остановки. Автобусы перебираются
+        // в порядке имён, поэтому внутри остановки они уже упорядочены; повторный заезд
+        // автобуса на остановку отсекается по последнему записанному автобусу
+        std::vector<BusPtr> last_bus(stops_.size(), nullptr);
+        stop_buses_offsets_.assign(stops_.size() + 1, 0);
+        for (const auto& [name, bus] : index_buses_) {
+            for (StopPtr stop : bus->stops_) {
+                if (last_bus[stop->id] != bus) {
+                    last_bus[stop->id] = bus;
+                    ++stop_buses_offsets_[stop->id + 1];
+                }
+            }
+        }
+        for (size_t id = 0; id < stops_.size(); ++id) {
+            stop_buses_offsets_[id + 1] += stop_buses_offsets_[id];
+        }
+
+        stop_buses_.assign(stop_buses_offsets_.back(), nullptr);
+        std::vector<uint32_t> positions(stop_buses_offsets_.begin(), std::prev(stop_buses_offsets_.end()));
+        std::fill(last_bus.begin(), last_bus.end(), nullptr);
+        for (const auto& [name, bus] : index_buses_) {
+            for (StopPtr stop : bus->stops_) {
+                if (last_bus[stop->id] != bus) {
+                    last_bus[stop->id] = bus;
+                    stop_buses_[positions[stop->id]++] = bus;
+                }
+            }
         }
-        return index_stops_.at(name);
+        stop_buses_outdated_ = false;
     }
 
-    BusPtr TransportCatalogue::FindBus(std::string_view name) const {
-        if (index_buses_.count(name) == 0) {
-            return nullptr;
+    void TransportCatalogue::CheckStopBusesBuilt() const {
+        if (stop_buses_outdated_) {
+            throw std::logic_error("stop buses are not built after AddBus");
         }
-        return index_buses_.at(name);
+    }
+
+    StopPtr TransportCatalogue::FindStop(std::string_view name) const {
+        const auto it = index_stops_.find(name);
+        return it == index_stops_.end() ? nullptr : it->second;
+    }
+
+    BusPtr TransportCatalogue::FindBus(std::string_view name) const {
+        const auto it = index_buses_.find(name);
+        return it == index_buses_.end() ? nullptr : it->second;
     }
 
     BusInfo TransportCatalogue::GetBusInfo(std::string_view name) const {
-        if (busname_to_businfo_.count(name) == 0) {
-            return ComputeBusInfo(name);
-        }
-        return *(busname_to_businfo_.at(name));
+        const auto it = busname_to_businfo_.find(name);
+        return it == busname_to_businfo_.end() ? ComputeBusInfo(name) : *it->second;
     }
 
     StopInfo TransportCatalogue::GetStopInfo(std::string_view stop_name) const {
-        if (index_stops_.count(stop_name) != 0) {
-            StopPtr stop_ptr = FindStop(stop_name);
-            if (buses_for_stops_.count(stop_ptr) != 0) {
-                StopInfo stop_info{ {}, true };
-
-                std::for_each(buses_for_stops_.at(stop_ptr).begin(),
-                    buses_for_stops_.at(stop_ptr).end(),
-                    [&](auto bus) {
-                        stop_info.buses_.insert(bus->name_);
-                    });
-                return stop_info;
-            }
-            else {
-                return StopInfo{ {}, true };
-            }
-        }
-        else {
+        StopPtr stop_ptr = FindStop(stop_name);
+        if (!stop_ptr) {
             return StopInfo{ {}, false };
         }
+        return StopInfo{ GetStopBuses(stop_ptr), true };
+    }
+
+    StopBusesRange TransportCatalogue::GetStopBuses(StopPtr stop) const {
+        CheckStopBusesBuilt();
+        const size_t id = static_cast<size_t>(stop->id);
+        if (id + 1 >= stop_buses_offsets_.size()) {
+            return {};
+        }
+        return { stop_buses_.begin() + stop_buses_offsets_[id], stop_buses_.begin() + stop_buses_offsets_[id + 1] };
+    }
+
+    std::vector<StopPtr> TransportCatalogue::GetStopsWithBusesSorted() const {
+        std::vector<StopPtr> result;
+        for (const auto& [name, stop] : index_stops_) {
+            const StopBusesRange buses = GetStopBuses(stop);
+            if (buses.begin() != buses.end()) {
+                result.push_back(stop);
+            }
+        }
+        return result;
     }
 
     void TransportCatalogue::SetDistance(std::pair<StopPtr, StopPtr> p, uint64_t distance) {
@@ -80,60 +191,45 @@ namespace catalogue {
         }
     }
 
-    BusInfo TransportCatalogue::ComputeBusInfo(std::string_view name) const {
-        BusPtr bus{ nullptr };
-        size_t stops_count = 0, unique_stops_count = 0;
-        double length_geo = 0;
-        uint64_t length_road = 0;
-        double curvature = 0.0;
-        if (bus = FindBus(name), bus) {
-            stops_count = bus->stops_.size();
-
-            std::unordered_set<std::string_view, std::hash<std::string_view>, std::equal_to<std::string_view>> unique_stops;
-            for_each(bus->stops_.begin(), bus->stops_.end(), [&unique_stops](StopPtr stop) {
-                unique_stops.insert(std::string_view(stop->name_));
-                });
-            unique_stops_count = unique_stops.size();
-
-            length_geo = std::transform_reduce(
-                next(bus->stops_.begin()), bus->stops_.end(),
-                bus->stops_.begin(),
-                0.0,
-                std::plus<>(),
-                [](StopPtr s, StopPtr prev_s) {
-                    if (s == prev_s) { return 0.0; }
-                    return ComputeDistance(prev_s->cordinates_, s->cordinates_);
-                }
-            );
-
-            length_road = std::transform_reduce(
-                next(bus->stops_.begin()), bus->stops_.end(),
-                bus->stops_.begin(),
-                0ULL,
-                std::plus<>(),
-                [this, &bus](StopPtr s, StopPtr prev_s) {
-                    if (bus->bus_type_ == BusType::CYCLED) {
-                        return GetDistance({ prev_s, s });
-                    }
-                    else if (bus->bus_type_ == BusType::ORDINARY) {
-                        return GetDistance({ prev_s, s }) + GetDistance({ s, prev_s });
-                    }
-                    else {
-                        uint64_t c = 0;
-                        return c;
-                    }
-                }
-            );
-            if (bus->bus_type_ == BusType::ORDINARY) {
-                length_geo *= 2;
-                stops_count = stops_count * 2 - 1;
+    void TransportCatalogue::FillBusDistances(Bus& bus) const {
+        const std::vector<StopPtr>& stops = bus.stops_;
+        const bool has_backward = bus.bus_type_ == BusType::ORDINARY;
+
+        bus.road_forward_.assign(stops.size(), 0);
+        bus.road_backward_.assign(has_backward ? stops.size() : 0, 0);
+        bus.geo_.assign(stops.size(), 0.0);
+        for (size_t i = 1; i < stops.size(); ++i) {
+            bus.road_forward_[i] = bus.road_forward_[i - 1] + GetDistance({ stops[i - 1], stops[i] });
+            if (has_backward) {
+                bus.road_backward_[i] = bus.road_backward_[i - 1] + GetDistance({ stops[i], stops[i - 1] });
             }
-            curvature = static_cast<long double>(length_road) / static_cast<long double>(length_geo);
-            return BusInfo{ stops_count, unique_stops_count, length_road, curvature, true };
+            bus.geo_[i] = bus.geo_[i - 1]
+                + (stops[i - 1] == stops[i] ? 0.0 : ComputeDistance(stops[i - 1]->cordinates_, stops[i]->cordinates_));
         }
-        else {
+    }
+
+    BusInfo TransportCatalogue::ComputeBusInfo(std::string_view name) const {
+        BusPtr bus = FindBus(name);
+        if (!bus) {
             return BusInfo{};
         }
+        size_t stops_count = bus->stops_.size();
+
+        std::unordered_set<std::string_view, std::hash<std::string_view>, std::equal_to<std::string_view>> unique_stops;
+        for_each(bus->stops_.begin(), bus->stops_.end(), [&unique_stops](StopPtr stop) {
+            unique_stops.insert(std::string_view(stop->name_));
+            });
+        const size_t unique_stops_count = unique_stops.size();
+
+        double length_geo = bus->geo_.empty() ? 0.0 : bus->geo_.back();
+        uint64_t length_road = bus->road_forward_.empty() ? 0 : bus->road_forward_.back();
+        if (bus->bus_type_ == BusType::ORDINARY) {
+            length_road += bus->road_backward_.empty() ? 0 : bus->road_backward_.back();
+            length_geo *= 2;
+            stops_count = stops_count * 2 - 1;
+        }
+        const double curvature = static_cast<long double>(length_road) / static_cast<long double>(length_geo);
+        return BusInfo{ stops_count, unique_stops_count, length_road, curvature, true };
     }
 
     std::deque<BusPtr> TransportCatalogue::GetBusesSorted() const {
@@ -144,8 +240,31 @@ namespace catalogue {
         return result;
     }
 
-    const std::unordered_map<StopPtr, std::set<BusPtr>>& TransportCatalogue::GetStopsToBuses() const {
-        return buses_for_stops_;
+    memory_stats::Report TransportCatalogue::GetMemoryStats() const {
+        using memory_stats::Collect;
+        using memory_stats::HeapBytes;
+
+        memory_stats::Report report;
+
+        report.push_back(names_.GetMemoryStats("names_"));
+        report.push_back(Collect("stops_", stops_));
+
+        memory_stats::ContainerStats& buses = report.emplace_back(Collect("buses_", buses_));
+        for (const Bus& bus : buses_) {
+            buses.heap_bytes += HeapBytes(bus.stops_) + HeapBytes(bus.road_forward_)
+                + HeapBytes(bus.road_backward_) + HeapBytes(bus.geo_);
+        }
+
+        report.push_back(Collect("index_stops_", index_stops_));
+        report.push_back(Collect("index_buses_", index_buses_));
+        report.push_back(Collect("bus_infos_", bus_infos_));
+        report.push_back(Collect("busname_to_businfo_", busname_to_businfo_));
+
+        report.push_back(Collect("stop_buses_offsets_", stop_buses_offsets_));
+        report.push_back(Collect("stop_buses_", stop_buses_));
+
+        report.push_back(Collect("distance_between_stops_", distance_between_stops_));
+        return report;
     }
 
     const std::map<std::string_view, StopPtr>& TransportCatalogue::GetStopnameToStops() const {
@@ -165,8 +284,23 @@ namespace catalogue {
         return distance_between_stops_;
     }
 
+    const std::vector<uint32_t>& TransportCatalogue::GetStopBusesOffsets() const {
+        CheckStopBusesBuilt();
+        return stop_buses_offsets_;
+    }
+
+    const std::vector<BusPtr>& TransportCatalogue::GetStopBusesFlat() const {
+        CheckStopBusesBuilt();
+        return stop_buses_;
+    }
+
+    std::string_view TransportCatalogue::SetNames(std::string_view names, size_t names_count) {
+        return names_.AddBlob(names, names_count);
+    }
+
     void TransportCatalogue::SetStops(std::deque<Stop>&& stops) {
         stops_.swap(stops);
+        stop_count_ = static_cast<int>(stops_.size());
     }
 
     void TransportCatalogue::SetStopnameToStop(std::map<std::string_view, StopPtr>&& stopname_to_stop) {
@@ -176,16 +310,29 @@ namespace catalogue {
 
     void TransportCatalogue::SetBuses(std::deque<Bus>&& buses) {
         buses_.swap(buses);
+        bus_count_ = static_cast<int>(buses_.size());
     }
     void TransportCatalogue::SetBusnameToBus(std::map<std::string_view, BusPtr>&& busname_to_bus) {
         index_buses_ = busname_to_bus;
     }
-    void TransportCatalogue::SetStopsToBuses(std::unordered_map<StopPtr, std::set<BusPtr>>&& stops_to_buses) {
-        buses_for_stops_ = stops_to_buses;
+    void TransportCatalogue::SetStopBuses(std::vector<uint32_t>&& offsets, std::vector<BusPtr>&& buses) {
+        stop_buses_offsets_ = std::move(offsets);
+        stop_buses_ = std::move(buses);
+        stop_buses_outdated_ = false;
     }
     void TransportCatalogue::SetDistanceBetweenStops(std::unordered_map<std::pair<StopPtr, StopPtr>, uint64_t, DistanceHasher>&& intervals_to_distance) {
         distance_between_stops_ = intervals_to_distance;
     }
+
+    void TransportCatalogue::FillMissingBusDistances() {
+        for (Bus& bus : buses_) {
+            const size_t backward_size = bus.bus_type_ == BusType::ORDINARY ? bus.stops_.size() : 0;
+            if (bus.road_forward_.size() != bus.stops_.size() || bus.road_backward_.size() != backward_size
+                || bus.geo_.size() != bus.stops_.size()) {
+                FillBusDistances(bus);
+            }
+        }
+    }
 } // namespace catalogue
 
 
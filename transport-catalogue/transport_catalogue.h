@@ -11,15 +11,41 @@
 #include <algorithm>
 
 #include "domain.h"
+#include "memory_stats.h"
+#include "string_pool.h"
 
 namespace catalogue
 {
+    // Описания для пакетной загрузки. Строки должны быть действительны во время вызова AddBulk
+    struct StopDescription {
+        std::string_view name;
+        geo::Coordinates coordinates;
+        // дорожные расстояния от этой остановки до соседних
+        std::vector<std::pair<std::string_view, int>> road_distances;
+    };
+
+    struct BusDescription {
+        std::string_view name;
+        std::vector<std::string_view> stops;
+        BusType type = BusType::ORDINARY;
+    };
+
     class TransportCatalogue {
 
     public:
-
-        void AddBus(std::string_view name, const std::vector<std::string>& stops, BusType type);
+        // Добавляет остановки, расстояния и автобусы за один вызов. Результат тот же,
+        // что у последовательных AddStop, SetDistance и AddBus, но контейнеры
+        // резервируются заранее, имена разрешаются через одну хеш-таблицу,
+        // а автобусы остановок раскладываются сортировкой подсчётом
+        void AddBulk(const std::vector<StopDescription>& stops, const std::vector<BusDescription>& buses);
+
+        // Расстояния между остановками автобуса должны быть заданы до его добавления
+        void AddBus(std::string_view name, const std::vector<std::string_view>& stops, BusType type);
         void AddStop(std::string_view name, geo::Coordinates coordinates);
+        // Раскладывает автобусы по остановкам. Вызывается после последовательных AddBus
+        // и при загрузке базы без готовых списков; AddBulk и SetStopBuses обходятся без него.
+        // Пока после AddBus он не вызван, GetStopBuses и GetStopInfo бросают logic_error
+        void BuildStopBuses();
 
         BusPtr FindBus(std::string_view name) const;
         StopPtr FindStop(std::string_view name) const;
@@ -30,24 +56,42 @@ namespace catalogue
         void SetDistance(std::pair<StopPtr, StopPtr> p, uint64_t distance);
         uint64_t GetDistance(std::pair<StopPtr, StopPtr> p) const;
 
-        const std::unordered_map<StopPtr, std::set<BusPtr>>& GetStopsToBuses() const;
+        // Автобусы остановки в порядке имён, без выделения памяти
+        StopBusesRange GetStopBuses(StopPtr stop) const;
+        // Остановки, через которые проходит хотя бы один автобус, в порядке имён
+        std::vector<StopPtr> GetStopsWithBusesSorted() const;
         const std::map<std::string_view, StopPtr>& GetStopnameToStops() const;
 
         std::deque<BusPtr> GetBusesSorted() const;
 
+        // Оценка занимаемой контейнерами памяти
+        memory_stats::Report GetMemoryStats() const;
+
         // serialization
         const std::deque<Stop>& GetStops() const;
         const std::deque<Bus>& GetBuses() const;
         const std::unordered_map<std::pair<StopPtr, StopPtr>, uint64_t, DistanceHasher>& GetIntervalsToDistance() const;
+        const std::vector<uint32_t>& GetStopBusesOffsets() const;
+        const std::vector<BusPtr>& GetStopBusesFlat() const;
 
+        // Загружает имена, записанные подряд, в пул. Имена остановок и автобусов
+        // должны ссылаться на возвращённое представление
+        std::string_view SetNames(std::string_view names, size_t names_count);
         void SetStops(std::deque<Stop>&& stops);
         void SetStopnameToStop(std::map<std::string_view, StopPtr>&& stopname_to_stop);
         void SetBuses(std::deque<Bus>&& buses);
         void SetBusnameToBus(std::map<std::string_view, BusPtr>&& busname_to_bus);
-        void SetStopsToBuses(std::unordered_map<StopPtr, std::set<BusPtr>>&& stops_to_buses);
+        // offsets и buses в формате GetStopBusesOffsets и GetStopBusesFlat
+        void SetStopBuses(std::vector<uint32_t>&& offsets, std::vector<BusPtr>&& buses);
         void SetDistanceBetweenStops(std::unordered_map<std::pair<StopPtr, StopPtr>, uint64_t, DistanceHasher>&& intervals_to_distance);
+        // Пересчитывает накопленные расстояния автобусов, загруженных без них или с неполными.
+        // Вызывается после SetBuses и SetDistanceBetweenStops
+        void FillMissingBusDistances();
 
     private:
+        // объявлен первым, чтобы разрушаться последним
+        StringPool names_;
+
         std::deque<Bus> buses_;
         std::deque<Stop> stops_;
 
@@ -57,8 +101,17 @@ namespace catalogue
         std::deque<BusInfo> bus_infos_;
         std::unordered_map<std::string_view, const BusInfo*> busname_to_businfo_;
         BusInfo ComputeBusInfo(std::string_view name) const;
-
-        std::unordered_map<StopPtr, std::set<BusPtr>> buses_for_stops_;
+        // расстояния между остановками должны быть заданы до вызова
+        void FillBusDistances(Bus& bus) const;
+
+        // Автобусы остановок в формате CSR: автобусы остановки с id i, упорядоченные по имени, -
+        // stop_buses_[stop_buses_offsets_[i]] .. stop_buses_[stop_buses_offsets_[i + 1] - 1].
+        // Строятся в AddBulk и BuildStopBuses или загружаются из базы; AddStop дописывает пустой список
+        std::vector<uint32_t> stop_buses_offsets_;
+        std::vector<BusPtr> stop_buses_;
+        // AddBus откладывает раскладку до BuildStopBuses; до неё чтение списков бросает logic_error
+        bool stop_buses_outdated_ = false;
+        void CheckStopBusesBuilt() const;
 
         std::unordered_map<std::pair<StopPtr, StopPtr>, uint64_t, DistanceHasher> distance_between_stops_;
 
@@ -1,5 +1,12 @@
+#define _USE_MATH_DEFINES
+
 #include "transport_router.h"
 
+#include <cmath>
+#include <limits>
+
+using namespace std::literals;
+
 namespace catalogue {
     TransportRouter::TransportRouter(RoutingSettings settings,
         const TransportCatalogue& cat)
@@ -25,24 +32,97 @@ namespace catalogue {
     void TransportRouter::AddBusWaitEdges() {
         route_graph_ = std::move(graph::DirectedWeightedGraph<BusRouteWeight>(vertex_index_to_stop_.size()));
         for (graph::VertexId vertex_from_id = 0; vertex_from_id < vertex_index_to_stop_.size(); vertex_from_id += 2) {
-            route_graph_.AddEdge({ vertex_from_id, vertex_from_id + 1, routing_settings_.bus_wait_time });
-            edge_index_to_bus_.push_back(nullptr);
+            AddEdge({ vertex_from_id, vertex_from_id + 1, routing_settings_.bus_wait_time }, nullptr, 0);
         }
     }
 
+    graph::EdgeId TransportRouter::AddEdge(const graph::Edge<BusRouteWeight>& edge, BusPtr bus, uint64_t distance) {
+        const graph::EdgeId edge_id = route_graph_.AddEdge(edge);
+        edge_index_to_bus_.push_back(bus);
+        edge_distances_.push_back(distance);
+        edge_infos_.push_back({
+            bus == nullptr,
+            bus ? std::string_view(bus->name_) : std::string_view{},
+            vertex_index_to_stop_[edge.from]->name_,
+            edge.weight.time,
+            edge.weight.span
+            });
+        return edge_id;
+    }
+
+    void TransportRouter::RebuildEdgeInfos() {
+        const auto& edges = route_graph_.GetEdges();
+        edge_infos_.clear();
+        edge_infos_.reserve(edges.size());
+        for (graph::EdgeId edge_id = 0; edge_id < edges.size(); ++edge_id) {
+            const BusPtr bus = edge_index_to_bus_.at(edge_id);
+            edge_infos_.push_back({
+                bus == nullptr,
+                bus ? std::string_view(bus->name_) : std::string_view{},
+                vertex_index_to_stop_.at(edges[edge_id].from)->name_,
+                edges[edge_id].weight.time,
+                edges[edge_id].weight.span
+                });
+        }
+    }
+
+    const EdgeInfo& TransportRouter::GetEdgeInfo(graph::EdgeId edge_id) const {
+        return edge_infos_[edge_id];
+    }
+
     void TransportRouter::AddBusEdges(std::string_view name) {
         if (cat_.index_buses_.count(name) == 0) {
             throw std::logic_error("No such bus");
         }
         BusPtr bus = cat_.index_buses_.at(name);
-        const std::vector<StopPtr>& stops = bus->stops_;
 
-        if (bus->bus_type_ == BusType::CYCLED) {
-            AddBusStopsEdges(bus, stops.begin(), stops.end());
+        std::vector<graph::VertexId> stop_vertices;
+        stop_vertices.reserve(bus->stops_.size());
+        for (StopPtr stop : bus->stops_) {
+            stop_vertices.push_back(GetStopVertexIndex(stop->name_));
         }
-        else {
-            AddBusStopsEdges(bus, stops.begin(), stops.end());
-            AddBusStopsEdges(bus, stops.rbegin(), stops.rend());
+
+        AddBusStopsEdges(bus, stop_vertices, false);
+        if (bus->bus_type_ == BusType::ORDINARY) {
+            AddBusStopsEdges(bus, stop_vertices, true);
+        }
+    }
+
+    void TransportRouter::AddBusStopsEdges(BusPtr bus, const std::vector<graph::VertexId>& stop_vertices, bool backward) {
+        const size_t stops_count = stop_vertices.size();
+        const std::vector<uint64_t>& distances = backward ? bus->road_backward_ : bus->road_forward_;
+        // при обратном проходе i-я по ходу движения остановка - stops_[stops_count - 1 - i]
+        auto position = [stops_count, backward](size_t i) {
+            return backward ? stops_count - 1 - i : i;
+        };
+
+        for (size_t i = 0; i + 1 < stops_count; ++i) {
+            const size_t from = position(i);
+            for (size_t j = i + 1; j < stops_count; ++j) {
+                const size_t to = position(j);
+                const uint64_t distance = backward ? distances[from] - distances[to] : distances[to] - distances[from];
+                AddEdge({
+                    stop_vertices[from] + 1,
+                    stop_vertices[to],
+                    {
+                        static_cast<double>(distance) / routing_settings_.bus_velocity,
+                        static_cast<int>(j - i)
+                    }
+                    }, bus, distance);
+            }
+        }
+    }
+
+    void TransportRouter::Customize(double bus_wait_time, double bus_velocity) {
+        routing_settings_.bus_wait_time = bus_wait_time;
+        routing_settings_.bus_velocity = bus_velocity;
+        for (graph::EdgeId edge_id = 0; edge_id < route_graph_.GetEdgeCount(); ++edge_id) {
+            const graph::Edge<BusRouteWeight>& edge = route_graph_.GetEdge(edge_id);
+            const double time = edge_index_to_bus_[edge_id] == nullptr
+                ? bus_wait_time
+                : static_cast<double>(edge_distances_[edge_id]) / bus_velocity;
+            route_graph_.SetEdgeWeight(edge_id, { time, edge.weight.span });
+            edge_infos_[edge_id].time = time;
         }
     }
 
@@ -73,6 +153,24 @@ namespace catalogue {
         return vertex_index_to_stop_[vertex_id];
     }
 
+    bool TransportRouter::IsStopArrivalVertex(graph::VertexId vertex_id) const {
+        return vertex_id % 2 == 0;
+    }
+
+    memory_stats::Report TransportRouter::GetMemoryStats() const {
+        memory_stats::Report report;
+        for (memory_stats::ContainerStats& graph_stats : route_graph_.GetMemoryStats()) {
+            graph_stats.name = "route_graph_."s + graph_stats.name;
+            report.push_back(std::move(graph_stats));
+        }
+        report.push_back(memory_stats::Collect("vertex_index_to_stop_", vertex_index_to_stop_));
+        report.push_back(memory_stats::Collect("edge_index_to_bus_", edge_index_to_bus_));
+        report.push_back(memory_stats::Collect("edge_infos_", edge_infos_));
+        report.push_back(memory_stats::Collect("edge_distances_", edge_distances_));
+        report.push_back(memory_stats::Collect("stopname_to_vertex_id_", stopname_to_vertex_id_));
+        return report;
+    }
+
     const std::deque<StopPtr>& TransportRouter::GetVertexIndexToStop() const {
         return vertex_index_to_stop_;
     }
@@ -81,8 +179,75 @@ namespace catalogue {
         return edge_index_to_bus_;
     }
 
+    const std::vector<uint64_t>& TransportRouter::GetEdgeDistances() const {
+        return edge_distances_;
+    }
+
+    RouteTimeLowerBound::RouteTimeLowerBound(const TransportRouter& transport_router, const TransportCatalogue& cat)
+        : wait_time_(transport_router.GetRoutingSettings().bus_wait_time) {
+        const std::deque<StopPtr>& vertex_index_to_stop = transport_router.GetVertexIndexToStop();
+        points_.reserve(vertex_index_to_stop.size() / 2);
+        for (size_t vertex = 0; vertex < vertex_index_to_stop.size(); vertex += 2) {
+            points_.push_back(ToUnitVector(vertex_index_to_stop[vertex]->cordinates_));
+        }
+
+        // наименьшее отношение дорожного расстояния к хорде; дорога может быть короче дуги
+        double min_ratio = std::numeric_limits<double>::infinity();
+        auto add_segment = [&min_ratio](StopPtr from, StopPtr to, uint64_t road) {
+            const double chord = Chord(ToUnitVector(from->cordinates_), ToUnitVector(to->cordinates_));
+            if (chord > 0.0) {
+                min_ratio = std::min(min_ratio, static_cast<double>(road) / chord);
+            }
+        };
+        for (const Bus& bus : cat.GetBuses()) {
+            for (size_t i = 1; i < bus.stops_.size(); ++i) {
+                add_segment(bus.stops_[i - 1], bus.stops_[i], bus.road_forward_[i] - bus.road_forward_[i - 1]);
+                if (!bus.road_backward_.empty()) {
+                    add_segment(bus.stops_[i], bus.stops_[i - 1], bus.road_backward_[i] - bus.road_backward_[i - 1]);
+                }
+            }
+        }
+        // запас на погрешность округления, чтобы оценка не превысила точный вес
+        time_per_chord_ = std::isfinite(min_ratio)
+            ? min_ratio / transport_router.GetRoutingSettings().bus_velocity * (1.0 - 1e-9)
+            : 0.0;
+    }
+
+    RouteTimeLowerBound::UnitVector RouteTimeLowerBound::ToUnitVector(geo::Coordinates coordinates) {
+        static const double dr = M_PI / 180.0;
+        const double cos_lat = std::cos(coordinates.lat * dr);
+        return {
+            cos_lat * std::cos(coordinates.lng * dr),
+            cos_lat * std::sin(coordinates.lng * dr),
+            std::sin(coordinates.lat * dr)
+        };
+    }
+
+    double RouteTimeLowerBound::Chord(const UnitVector& lhs, const UnitVector& rhs) {
+        const double dx = lhs.x - rhs.x;
+        const double dy = lhs.y - rhs.y;
+        const double dz = lhs.z - rhs.z;
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    void RouteTimeLowerBound::SetTarget(graph::VertexId to) {
+        target_stop_ = to / 2;
+        target_point_ = points_.at(target_stop_);
+    }
+
+    BusRouteWeight RouteTimeLowerBound::operator()(graph::VertexId vertex) const {
+        const graph::VertexId stop = vertex / 2;
+        if (stop == target_stop_) {
+            return {};
+        }
+        const double wait = vertex % 2 == 0 ? wait_time_ : 0.0;
+        return { wait + Chord(points_[stop], target_point_) * time_per_chord_, 0 };
+    }
+
     void TransportRouter::SetRouteGraph(graph::DirectedWeightedGraph<BusRouteWeight>&& route_graph) {
         route_graph_ = route_graph;
+        // вершины и автобусы рёбер задаются раньше графа
+        RebuildEdgeInfos();
     }
     void TransportRouter::SetVertexIndexToStop(std::deque<StopPtr>&& vertex_index_to_stop) {
         vertex_index_to_stop_ = vertex_index_to_stop;
@@ -90,6 +255,9 @@ namespace catalogue {
     void TransportRouter::SetEdgeIndexToBus(std::deque<BusPtr>&& edge_index_to_bus) {
         edge_index_to_bus_ = edge_index_to_bus;
     }
+    void TransportRouter::SetEdgeDistances(std::vector<uint64_t>&& edge_distances) {
+        edge_distances_ = std::move(edge_distances);
+    }
     void TransportRouter::SetStopnameToVertexId(std::map<std::string_view, graph::VertexId>&& stopname_to_vertex_id) {
         stopname_to_vertex_id_ = stopname_to_vertex_id;
     }
@@ -8,9 +8,37 @@
 #include "graph.h"
 
 namespace catalogue {
+    // Способ ответа на запросы Route
+    enum class RouterAlgorithm {
+        // матрица кратчайших путей между всеми парами вершин строится в make_base и хранится в базе
+        ALL_PAIRS,
+        // поиск Дейкстры при обработке запросов, один на каждую остановку отправления
+        DIJKSTRA,
+        // поиск A* с географической нижней оценкой, один на каждый запрос
+        A_STAR,
+        // поиск A* с оценкой по ориентирам, времена ориентиров строятся в make_base
+        ALT
+    };
+
     struct RoutingSettings {
         double bus_wait_time = 0.0;
         double bus_velocity = 0.0;
+        RouterAlgorithm algorithm = RouterAlgorithm::ALL_PAIRS;
+        // число ориентиров для RouterAlgorithm::ALT
+        size_t landmark_count = 8;
+        // строить метки хабов для запросов RouteTime
+        bool hub_labels = false;
+    };
+
+    // Данные ребра графа, нужные для ответа на запрос Route
+    struct EdgeInfo {
+        bool is_wait = false;
+        // пустое для ребра ожидания
+        std::string_view bus_name;
+        // остановка, из которой выходит ребро
+        std::string_view stop_name;
+        double time = 0.0;
+        int span_count = 0;
     };
 
     class TransportRouter {
@@ -21,10 +49,19 @@ namespace catalogue {
 
         std::deque<StopPtr> vertex_index_to_stop_;
         std::deque<BusPtr> edge_index_to_bus_;
+        // параллелен рёбрам графа
+        std::vector<EdgeInfo> edge_infos_;
+        // Дорожное расстояние ребра поездки, у ребра ожидания 0; параллелен рёбрам графа.
+        // Вместе с span рёбер не зависит от bus_wait_time и bus_velocity
+        std::vector<uint64_t> edge_distances_;
         std::map<std::string_view, graph::VertexId> stopname_to_vertex_id_;
 
-        template <typename ForwardIt>
-        void AddBusStopsEdges(BusPtr bus, ForwardIt first_stop, ForwardIt last_stop);
+        // Рёбра между всеми парами остановок bus в прямом или обратном направлении.
+        // stop_vertices - вершины прибытия остановок bus->stops_
+        void AddBusStopsEdges(BusPtr bus, const std::vector<graph::VertexId>& stop_vertices, bool backward);
+
+        graph::EdgeId AddEdge(const graph::Edge<BusRouteWeight>& edge, BusPtr bus, uint64_t distance);
+        void RebuildEdgeInfos();
 
     public:
         explicit TransportRouter(RoutingSettings settings,
@@ -36,6 +73,10 @@ namespace catalogue {
         void AddBusWaitEdges();
         void AddBusEdges(std::string_view name);
 
+        // Пересчитывает веса рёбер по расстояниям для новых bus_wait_time и bus_velocity
+        // за один проход по рёбрам; структура графа не меняется
+        void Customize(double bus_wait_time, double bus_velocity);
+
         template <typename Weight>
         const graph::DirectedWeightedGraph<Weight>& GetRouteGraph() const;
 
@@ -43,45 +84,62 @@ namespace catalogue {
         BusPtr GetBusByEdgeIndex(graph::EdgeId edge_id) const;
         const graph::Edge<BusRouteWeight>& GetEdgeByIndex(graph::EdgeId edge_id) const;
         StopPtr GetStopByVertexIndex(graph::VertexId vertex_id) const;
+        // без проверки границ, edge_id должен быть ребром графа
+        const EdgeInfo& GetEdgeInfo(graph::EdgeId edge_id) const;
+        // у каждой остановки две вершины: прибытия (чётная) и посадки (нечётная)
+        bool IsStopArrivalVertex(graph::VertexId vertex_id) const;
+
+        // Оценка занимаемой памяти, включая граф маршрутов
+        memory_stats::Report GetMemoryStats() const;
 
         //serialization
         const RoutingSettings& GetRoutingSettings() const;
         const std::deque<StopPtr>& GetVertexIndexToStop() const;
         const std::deque<BusPtr>& GetEdgeIndexToBus() const;
+        const std::vector<uint64_t>& GetEdgeDistances() const;
 
         void SetRouteGraph(graph::DirectedWeightedGraph<BusRouteWeight>&& route_graph);
         void SetVertexIndexToStop(std::deque<StopPtr>&& vertex_index_to_stop);
         void SetEdgeIndexToBus(std::deque<BusPtr>&& edge_index_to_bus);
+        void SetEdgeDistances(std::vector<uint64_t>&& edge_distances);
         void SetStopnameToVertexId(std::map<std::string_view, graph::VertexId>&& stopname_to_vertex_id);
 
     };
 
+    // Согласованная нижняя оценка времени пути по графу TransportRouter до вершины прибытия цели.
+    // Хорда между остановками не длиннее дуги и удовлетворяет неравенству треугольника,
+    // поэтому время поездки не меньше хорды, умноженной на наименьшее по перегонам автобусов
+    // отношение дороги к хорде и делённой на скорость. С вершины прибытия другой остановки
+    // к этому добавляется ожидание
+    class RouteTimeLowerBound {
+    public:
+        RouteTimeLowerBound(const TransportRouter& transport_router, const TransportCatalogue& cat);
+
+        void SetTarget(graph::VertexId to);
+        BusRouteWeight operator()(graph::VertexId vertex) const;
+
+    private:
+        // точка на единичной сфере, считается из синусов и косинусов координат один раз
+        struct UnitVector {
+            double x = 0.0;
+            double y = 0.0;
+            double z = 0.0;
+        };
+        static UnitVector ToUnitVector(geo::Coordinates coordinates);
+        static double Chord(const UnitVector& lhs, const UnitVector& rhs);
+
+        // по номеру остановки в графе (vertex / 2)
+        std::vector<UnitVector> points_;
+        double wait_time_ = 0.0;
+        // минут на единицу длины хорды на единичной сфере
+        double time_per_chord_ = 0.0;
+        graph::VertexId target_stop_ = 0;
+        UnitVector target_point_;
+    };
+
     template <typename Weight>
     const graph::DirectedWeightedGraph<Weight>& TransportRouter::GetRouteGraph() const {
         return route_graph_;
     }
 
-    template <typename ForwardIt>
-    void TransportRouter::AddBusStopsEdges(BusPtr bus, ForwardIt first_stop, ForwardIt last_stop) {
-        double current_distance = 0.0;
-        int span_count = 0;
-        for (auto it_from = first_stop; it_from != std::prev(last_stop); ++it_from) {
-            for (auto it_to = std::next(it_from); it_to != last_stop; ++it_to) {
-                current_distance = current_distance + cat_.GetDistance({ *(std::prev(it_to)), *it_to });
-                ++span_count;
-                route_graph_.AddEdge({
-                    GetStopVertexIndex((*it_from)->name_) + 1,
-                    GetStopVertexIndex((*it_to)->name_),
-                    {
-                        current_distance / routing_settings_.bus_velocity,
-                        span_count
-                    }
-                    });
-                edge_index_to_bus_.push_back(bus);
-            }
-            current_distance = 0.0;
-            span_count = 0;
-        }
-    }
-
 } // namespace catalogue
\ No newline at end of file